@@ -0,0 +1,135 @@
+// https://en.wikipedia.org/wiki/Hunt%E2%80%93Szymanski_algorithm
+// https://www.researchgate.net/publication/220770888
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "array.hh"
+
+namespace ext
+{
+
+namespace arr
+{
+
+/** @return A longest common subsequence of a and b in O((r + n) log n) */
+template <typename T>
+std::vector<T>
+lcs (const std::vector<T> &a, const std::vector<T> &b)
+{
+    // the positions of each value in b, sorted by value and then position
+    std::vector<std::pair<T, int64_t> > pos (b.size ());
+    for (size_t j = 0; j < b.size (); ++j)
+        pos[j] = { b[j], (int64_t)j };
+
+    std::sort (pos.begin (), pos.end ());
+
+    // every match of a[i] lists its positions in b in decreasing order, so
+    // that at most one of them is used by a strictly increasing subsequence.
+    // such a subsequence is then a common subsequence, and the other way
+    // around
+    std::vector<int64_t> matches;
+    for (const T &x : a) {
+        auto lo = std::lower_bound (pos.begin (), pos.end (),
+                                    std::pair<T, int64_t> (x, INT64_MIN));
+        auto hi = std::lower_bound (lo, pos.end (),
+                                    std::pair<T, int64_t> (x, INT64_MAX));
+
+        for (auto it = hi; it != lo;)
+            matches.push_back ((--it)->second);
+    }
+
+    std::vector<int64_t> js = lis<INCR> (matches);
+
+    std::vector<T> subseq (js.size ());
+    for (size_t k = 0; k < js.size (); ++k)
+        subseq[k] = b[js[k]];
+
+    return subseq;
+}
+
+/** @return The length of a longest common subsequence of a and b in
+ * O(n m / 64) */
+template <typename T>
+size_t
+lcs_length (const std::vector<T> &a, const std::vector<T> &b)
+{
+    const size_t N = a.size ();
+    const size_t W = (N + 63) / 64;
+
+    if (N == 0 || b.empty ())
+        return 0;
+
+    std::vector<T> vals (a);
+    std::sort (vals.begin (), vals.end ());
+    vals.erase (std::unique (vals.begin (), vals.end ()), vals.end ());
+
+    // match[c * W, (c + 1) * W) has bit i set if a[i] == vals[c]
+    std::vector<uint64_t> match (vals.size () * W, 0);
+    for (size_t i = 0; i < N; ++i) {
+        size_t c = std::lower_bound (vals.begin (), vals.end (), a[i])
+                   - vals.begin ();
+
+        match[c * W + (i >> 6)] |= (uint64_t)1 << (i & 63);
+    }
+
+    // bit i of v is 0 if row i of the DP table increases there. each row of
+    // b is V' = (V + U) | (V - U) with U = V & M. U is a subset of V, so
+    // V - U never borrows and is V & ~M, and only the sum carries across
+    // the words
+    std::vector<uint64_t> v (W, ~(uint64_t)0);
+
+    for (const T &y : b) {
+        auto it = std::lower_bound (vals.begin (), vals.end (), y);
+        if (it == vals.end () || *it != y)
+            continue; // U is 0, so V does not change
+
+        const uint64_t *m = &match[(it - vals.begin ()) * W];
+
+        uint64_t carry = 0;
+        for (size_t w = 0; w < W; ++w) {
+            uint64_t u = v[w] & m[w];
+
+            uint64_t sum = v[w] + u;
+            uint64_t c1  = sum < u;
+            sum += carry;
+            carry = c1 | (sum < carry);
+
+            v[w] = sum | (v[w] & ~m[w]);
+        }
+    }
+
+    // a carry can run into the bits past N, so they are masked out
+    if (N & 63)
+        v[W - 1] |= ~(uint64_t)0 << (N & 63);
+
+    size_t zeros = 0;
+    for (size_t w = 0; w < W; ++w)
+        zeros += __builtin_popcountll (~v[w]);
+
+    return zeros;
+}
+
+template std::vector<int8_t>  lcs (const std::vector<int8_t> &a,
+                                   const std::vector<int8_t> &b);
+template std::vector<int16_t> lcs (const std::vector<int16_t> &a,
+                                   const std::vector<int16_t> &b);
+template std::vector<int32_t> lcs (const std::vector<int32_t> &a,
+                                   const std::vector<int32_t> &b);
+template std::vector<int64_t> lcs (const std::vector<int64_t> &a,
+                                   const std::vector<int64_t> &b);
+
+template size_t lcs_length (const std::vector<int8_t> &a,
+                            const std::vector<int8_t> &b);
+template size_t lcs_length (const std::vector<int16_t> &a,
+                            const std::vector<int16_t> &b);
+template size_t lcs_length (const std::vector<int32_t> &a,
+                            const std::vector<int32_t> &b);
+template size_t lcs_length (const std::vector<int64_t> &a,
+                            const std::vector<int64_t> &b);
+
+} // namespace arr
+
+} // namespace ext
@@ -1,9 +1,12 @@
 #include <algorithm>
-#include <functional>
+#include <barrier>
+#include <cstdint>
 #include <limits>
+#include <thread>
 #include <vector>
 
 #include "array.hh"
+#include "util.hh"
 
 namespace ext
 {
@@ -11,77 +14,388 @@ namespace ext
 namespace arr
 {
 
+/** @return If an element equal to y can follow an element equal to x in a
+ * subsequence of type SQ. */
+template <sqtype_e SQ, typename T>
+static inline bool
+follows_ (const T &x, const T &y)
+{
+    if constexpr (SQ == INCR)
+        return x < y;
+    else if constexpr (SQ == DECR)
+        return x > y;
+    else if constexpr (SQ == NDCR)
+        return x <= y;
+    else
+        return x >= y;
+}
+
+/** @return The number of elements of the non-empty range [d, d + len) that x
+ * can follow, which must be a prefix of it. */
+template <sqtype_e SQ, typename T>
+static inline size_t
+search_ (const T *d, size_t len, const T &x)
+{
+    // the step only decides which half to keep, so the compiler can use a
+    // conditional move instead of a branch
+    const T *base = d;
+    while (len > 1) {
+        size_t half = len >> 1;
+        base        = follows_<SQ> (base[half - 1], x) ? base + half : base;
+        len -= half;
+    }
+
+    return (base - d) + follows_<SQ> (*base, x);
+}
+
+template <sqtype_e SQ, typename T, typename I>
+static std::vector<T>
+lis_ (const std::vector<T> &arr)
+{
+    const size_t SZ   = arr.size ();
+    const I      NONE = std::numeric_limits<I>::max ();
+
+    // d[l] is the best element at which a subsequence of length l + 1 ends,
+    // and idxs[l] is its index. only d[0, len) is ever searched
+    std::vector<T> d (SZ);
+    std::vector<I> idxs (SZ);
+    std::vector<I> prev (SZ);
+    size_t         len = 0;
+
+    for (size_t i = 0; i < SZ; ++i) {
+        size_t l = len ? search_<SQ> (d.data (), len, arr[i]) : 0;
+
+        // an equal element already ends a strict subsequence of this length,
+        // keep the earlier one
+        if constexpr (SQ == INCR || SQ == DECR)
+            if (l < len && d[l] == arr[i])
+                continue;
+
+        d[l]    = arr[i];
+        idxs[l] = i;
+        prev[i] = l ? idxs[l - 1] : NONE;
+
+        len += l == len;
+    }
+
+    std::vector<T> &subseq = d; // use the memory allocated by d
+    subseq.resize (len);
+
+    for (I pos = len ? idxs[len - 1] : NONE, k = len; pos != NONE;
+         pos = prev[pos])
+        subseq[--k] = arr[pos];
+
+    return subseq;
+}
+
+/** @return the longest subsequence of type SQ in the array in O(NlogN) */
+template <sqtype_e SQ, typename T>
+std::vector<T>
+lis (const std::vector<T> &arr)
+{
+    // indices only need to be as wide as the input
+    if (arr.size () < std::numeric_limits<uint32_t>::max ())
+        return lis_<SQ, T, uint32_t> (arr);
+
+    return lis_<SQ, T, uint64_t> (arr);
+}
+
 /** @return the longest increasing subsequence in the array in O(NlogN) */
 template <typename T>
 std::vector<T>
 lis (const std::vector<T> &arr, const sqtype_e &sqtype)
 {
-    bool    is_incr_d = sqtype == INCR || sqtype == NDCR;
-    const T maxv      = std::numeric_limits<T> ().max ();
-    const T minv      = std::numeric_limits<T> ().min ();
+    switch (sqtype) {
+        case INCR:
+            return lis<INCR> (arr);
+        case DECR:
+            return lis<DECR> (arr);
+        case NDCR:
+            return lis<NDCR> (arr);
+        default:
+            return lis<NICR> (arr);
+    }
+}
 
-    const size_t SZ  = arr.size ();
-    const T      DFT = is_incr_d ? maxv : minv;
+/** @return If x is a better end for a subsequence of type SQ than y. */
+template <sqtype_e SQ, typename T>
+static inline bool
+better_ (const T &x, const T &y)
+{
+    if constexpr (SQ == INCR || SQ == NDCR)
+        return x < y;
+    else
+        return x > y;
+}
 
-    // d[l] is the smallest element at which an
-    // increasing subsequence of length l ends.
+template <sqtype_e SQ, typename T>
+static std::vector<T>
+par_lis_ (const std::vector<T> &arr, size_t threads)
+{
+    // the array is split into blocks, and a tree over the blocks stores the
+    // best element of each subtree that has not been assigned a rank yet.
+    // phase r assigns rank r to every remaining element that can not follow
+    // any remaining element before it, which are exactly the elements whose
+    // subsequences end with length r. each thread owns one subtree of the
+    // tree, and only needs the best element of the subtrees before its own
+    constexpr size_t BLOCK = 32;
 
-    std::vector<T>   d (SZ + 1, DFT);
-    std::vector<int> idxs (SZ + 1, -1);
-    std::vector<int> prev (SZ + 1, -1);
-    d[0] = is_incr_d ? minv : maxv;
+    struct node_t {
+        T      best;
+        size_t cnt; // number of remaining elements
+    };
 
-    for (size_t i = 0; i < SZ; ++i) {
-        size_t                                     l;
-        std::function<bool (const T &, const T &)> cmp;
-
-        switch (sqtype) {
-            case INCR:
-                l = std::upper_bound (d.begin (), d.end (), arr[i])
-                    - d.begin ();
-                cmp = [] (const T &lhs, const T &rhs) { return lhs < rhs; };
-                break;
-            case DECR:
-                l = std::upper_bound (d.begin (), d.end (), arr[i],
-                                      std::greater<T> ())
-                    - d.begin ();
-                cmp = [] (const T &lhs, const T &rhs) { return lhs > rhs; };
-                break;
-            case NDCR:
-                l = std::lower_bound (d.begin (), d.end (), arr[i])
-                    - d.begin ();
-                cmp = [] (const T &lhs, const T &rhs) { return lhs <= rhs; };
-                break;
-            case NICR:
-                l = std::lower_bound (d.begin (), d.end (), arr[i],
-                                      std::greater<T> ())
-                    - d.begin ();
-                cmp = [] (const T &lhs, const T &rhs) { return lhs >= rhs; };
-                break;
+    auto merge = [] (const node_t &l, const node_t &r) {
+        if (l.cnt == 0)
+            return r;
+        if (r.cnt == 0)
+            return l;
+
+        return node_t{ better_<SQ> (r.best, l.best) ? r.best : l.best,
+                       l.cnt + r.cnt };
+    };
+
+    const size_t SZ     = arr.size ();
+    const size_t NB     = (SZ + BLOCK - 1) / BLOCK;
+    const size_t S      = (size_t)1 << (63 - __builtin_clzll (threads));
+    const size_t LEAVES = std::max (utl::next_p2 (NB), S);
+
+    std::vector<node_t>   tree (LEAVES << 1, node_t{ T (), 0 });
+    std::vector<uint32_t> rank (SZ, 0); // 0 while unassigned
+
+    // bound_[t] is the best remaining element before subtree t, if has_[t]
+    std::vector<T>       bound (S);
+    std::vector<uint8_t> has (S);
+    uint32_t             r    = 0;
+    bool                 done = false;
+
+    auto scan = [&] (size_t b, T &bnd, bool &hb) {
+        node_t nd{ T (), 0 };
+        for (size_t i = b * BLOCK, e = std::min (SZ, i + BLOCK); i < e; ++i) {
+            if (rank[i])
+                continue;
+
+            if (!hb || !follows_<SQ> (bnd, arr[i])) {
+                rank[i] = r;
+                bnd     = arr[i];
+                hb      = true;
+            } else {
+                nd = merge (nd, node_t{ arr[i], 1 });
+            }
         }
 
-        if (cmp (d[l - 1], arr[i])) {
-            d[l]    = arr[i];
-            idxs[l] = i;
-            prev[i] = idxs[l - 1];
+        tree[LEAVES + b] = nd;
+    };
+
+    auto visit = [&] (auto &&self, size_t pos, T &bnd, bool &hb) -> void {
+        const node_t &nd = tree[pos];
+        if (nd.cnt == 0 || (hb && follows_<SQ> (bnd, nd.best)))
+            return;
+
+        if (pos >= LEAVES) {
+            scan (pos - LEAVES, bnd, hb);
+            return;
+        }
+
+        self (self, pos << 1, bnd, hb);
+        self (self, (pos << 1) | 1, bnd, hb);
+        tree[pos] = merge (tree[pos << 1], tree[(pos << 1) | 1]);
+    };
+
+    auto build = [&] (auto &&self, size_t pos) -> void {
+        if (pos >= LEAVES) {
+            node_t nd{ T (), 0 };
+            size_t b = pos - LEAVES;
+            for (size_t i = b * BLOCK; i < std::min (SZ, (b + 1) * BLOCK); ++i)
+                nd = merge (nd, node_t{ arr[i], 1 });
+
+            tree[pos] = nd;
+            return;
+        }
+
+        self (self, pos << 1);
+        self (self, (pos << 1) | 1);
+        tree[pos] = merge (tree[pos << 1], tree[(pos << 1) | 1]);
+    };
+
+    // runs on one thread between phases
+    auto next_phase = [&] () noexcept {
+        T    bnd = T ();
+        bool hb  = false;
+
+        size_t total = 0;
+        for (size_t t = 0; t < S; ++t) {
+            bound[t] = bnd;
+            has[t]   = hb;
+
+            const node_t &nd = tree[S + t];
+            if (nd.cnt && (!hb || better_<SQ> (nd.best, bnd))) {
+                bnd = nd.best;
+                hb  = true;
+            }
+
+            total += nd.cnt;
+        }
+
+        if (total == 0)
+            done = true;
+        else
+            ++r;
+    };
+
+    std::barrier sync (S, next_phase);
+
+    auto work = [&] (size_t t) {
+        build (build, S + t);
+        sync.arrive_and_wait ();
+
+        while (!done) {
+            T    bnd = bound[t];
+            bool hb  = has[t];
+
+            visit (visit, S + t, bnd, hb);
+            sync.arrive_and_wait ();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < S; ++t)
+        pool.emplace_back (work, t);
+
+    work (0);
+
+    for (std::thread &th : pool)
+        th.join ();
+
+    // walk back from the end, taking the last element of each rank before
+    // the previous one, as lis does. for strict subsequences lis keeps the
+    // first of a run of equal elements with the same rank
+    std::vector<T> subseq (r);
+
+    size_t i = SZ;
+    for (uint32_t want = r; want > 0; --want) {
+        while (rank[--i] != want)
+            ;
+
+        if constexpr (SQ == INCR || SQ == DECR) {
+            for (size_t k = i; k-- > 0;) {
+                if (rank[k] != want)
+                    continue;
+                if (arr[k] != arr[i])
+                    break;
+
+                i = k;
+            }
         }
+
+        subseq[want - 1] = arr[i];
     }
 
-    int pos = -1;
-    for (size_t l = 0; l <= SZ; ++l) {
-        if (d[l] != DFT)
-            pos = idxs[l];
+    return subseq;
+}
+
+/** @return the longest subsequence of type sqtype in the array, the same one
+ * lis returns, using up to threads threads */
+template <typename T>
+std::vector<T>
+par_lis (const std::vector<T> &arr, const sqtype_e &sqtype, size_t threads)
+{
+    if (threads == 0)
+        threads = std::max (1u, std::thread::hardware_concurrency ());
+
+    // below this the threads cost more than they save
+    if (threads == 1 || arr.size () < ((size_t)1 << 16))
+        return lis (arr, sqtype);
+
+    // there is one phase per element of the subsequence, so a long one is
+    // faster sequentially. the subsequence of a strided sample, scaled back
+    // up, overestimates its length for random inputs and matches it for
+    // sorted ones
+    constexpr size_t STRIDE = 64;
+
+    std::vector<T> sample;
+    sample.reserve (arr.size () / STRIDE + 1);
+    for (size_t i = 0; i < arr.size (); i += STRIDE)
+        sample.push_back (arr[i]);
+
+    if (lis (sample, sqtype).size () * STRIDE > arr.size () / 256)
+        return lis (arr, sqtype);
+
+    switch (sqtype) {
+        case INCR:
+            return par_lis_<INCR> (arr, threads);
+        case DECR:
+            return par_lis_<DECR> (arr, threads);
+        case NDCR:
+            return par_lis_<NDCR> (arr, threads);
+        default:
+            return par_lis_<NICR> (arr, threads);
     }
+}
 
-    std::vector<T> &subseq = d; // use the memory allocated by d
-    subseq.clear ();
+template <typename T, sqtype_e SQ>
+online_lis<T, SQ>::online_lis (bool keep_seq) : keep_seq_ (keep_seq)
+{
+}
+
+/** Appends val to the stream.
+ * @return The length of the longest subsequence so far. */
+template <typename T, sqtype_e SQ>
+size_t
+online_lis<T, SQ>::push (const T &val)
+{
+    const size_t len = d_.size ();
+    const size_t l   = len ? search_<SQ> (d_.data (), len, val) : 0;
+
+    if (keep_seq_)
+        vals_.push_back (val);
+
+    // same tie breaking as lis_
+    if constexpr (SQ == INCR || SQ == DECR)
+        if (l < len && d_[l] == val)
+            return len;
 
-    while (pos != -1) {
-        subseq.push_back (arr[pos]);
-        pos = prev[pos];
+    if (l == len) {
+        d_.push_back (val);
+        if (keep_seq_)
+            idxs_.push_back (0);
+    } else {
+        d_[l] = val;
     }
 
-    std::reverse (subseq.begin (), subseq.end ());
+    if (keep_seq_) {
+        size_t i = vals_.size () - 1;
+
+        prev_.resize (vals_.size ());
+        prev_[i] = l ? idxs_[l - 1] : SIZE_MAX;
+        idxs_[l] = i;
+    }
+
+    return d_.size ();
+}
+
+/** @return The length of the longest subsequence so far. */
+template <typename T, sqtype_e SQ>
+size_t
+online_lis<T, SQ>::length () const
+{
+    return d_.size ();
+}
+
+/** @return The longest subsequence so far, the same one lis would return, or
+ * nothing if keep_seq is false. */
+template <typename T, sqtype_e SQ>
+std::vector<T>
+online_lis<T, SQ>::reconstruct () const
+{
+    if (!keep_seq_ || d_.empty ())
+        return {};
+
+    std::vector<T> subseq (d_.size ());
+
+    size_t k = d_.size ();
+    for (size_t pos = idxs_.back (); pos != SIZE_MAX; pos = prev_[pos])
+        subseq[--k] = vals_[pos];
 
     return subseq;
 }
@@ -127,6 +441,74 @@ cnt_lis (const std::vector<T> &arr)
     return ans;
 }
 
+/** @return a + b modulo mod, or modulo 2^64 if mod is 0. */
+static inline uint64_t
+add_mod_ (uint64_t a, uint64_t b, uint64_t mod)
+{
+    if (mod == 0)
+        return a + b;
+
+    // a and b are below mod, but a + b may still overflow
+    return a >= mod - b ? a - (mod - b) : a + b;
+}
+
+/** @return the number of distinct LIS in O(NlogN) */
+template <typename T>
+uint64_t
+cnt_lis_nlogn (const std::vector<T> &arr, uint64_t mod)
+{
+    const size_t SZ = arr.size ();
+    if (SZ == 0)
+        return 0;
+
+    // compress the values to their ranks so the tree can be indexed by them
+    std::vector<T> vals (arr);
+    std::sort (vals.begin (), vals.end ());
+    vals.erase (std::unique (vals.begin (), vals.end ()), vals.end ());
+
+    const size_t NV = vals.size ();
+
+    // a binary indexed tree over the ranks that stores, for every prefix of
+    // ranks, the longest subsequence ending in one of them and the number of
+    // such subsequences
+    struct best_t {
+        uint32_t len;
+        uint64_t cnt;
+    };
+
+    auto merge = [mod] (best_t &lhs, const best_t &rhs) {
+        if (rhs.len > lhs.len)
+            lhs = rhs;
+        else if (rhs.len == lhs.len && rhs.len != 0)
+            lhs.cnt = add_mod_ (lhs.cnt, rhs.cnt, mod);
+    };
+
+    std::vector<best_t> bit (NV + 1, best_t{ 0, 0 });
+    best_t              ans{ 0, 0 };
+
+    for (size_t i = 0; i < SZ; ++i) {
+        size_t r = std::lower_bound (vals.begin (), vals.end (), arr[i])
+                   - vals.begin ();
+
+        // the best subsequence ending in a strictly smaller value
+        best_t cur{ 0, 0 };
+        for (size_t j = r; j > 0; j -= j & -j)
+            merge (cur, bit[j]);
+
+        if (cur.len == 0)
+            cur.cnt = mod == 1 ? 0 : 1;
+
+        ++cur.len;
+
+        for (size_t j = r + 1; j <= NV; j += j & -j)
+            merge (bit[j], cur);
+
+        merge (ans, cur);
+    }
+
+    return ans.cnt;
+}
+
 template std::vector<int8_t>  lis (const std::vector<int8_t> &arr,
                                    const sqtype_e            &sqtype);
 template std::vector<int16_t> lis (const std::vector<int16_t> &arr,
@@ -136,11 +518,73 @@ template std::vector<int32_t> lis (const std::vector<int32_t> &arr,
 template std::vector<int64_t> lis (const std::vector<int64_t> &arr,
                                    const sqtype_e             &sqtype);
 
+template std::vector<int8_t>  lis<INCR> (const std::vector<int8_t> &arr);
+template std::vector<int16_t> lis<INCR> (const std::vector<int16_t> &arr);
+template std::vector<int32_t> lis<INCR> (const std::vector<int32_t> &arr);
+template std::vector<int64_t> lis<INCR> (const std::vector<int64_t> &arr);
+
+template std::vector<int8_t>  lis<DECR> (const std::vector<int8_t> &arr);
+template std::vector<int16_t> lis<DECR> (const std::vector<int16_t> &arr);
+template std::vector<int32_t> lis<DECR> (const std::vector<int32_t> &arr);
+template std::vector<int64_t> lis<DECR> (const std::vector<int64_t> &arr);
+
+template std::vector<int8_t>  lis<NDCR> (const std::vector<int8_t> &arr);
+template std::vector<int16_t> lis<NDCR> (const std::vector<int16_t> &arr);
+template std::vector<int32_t> lis<NDCR> (const std::vector<int32_t> &arr);
+template std::vector<int64_t> lis<NDCR> (const std::vector<int64_t> &arr);
+
+template std::vector<int8_t>  lis<NICR> (const std::vector<int8_t> &arr);
+template std::vector<int16_t> lis<NICR> (const std::vector<int16_t> &arr);
+template std::vector<int32_t> lis<NICR> (const std::vector<int32_t> &arr);
+template std::vector<int64_t> lis<NICR> (const std::vector<int64_t> &arr);
+
+template std::vector<int8_t>  par_lis (const std::vector<int8_t> &arr,
+                                       const sqtype_e            &sqtype,
+                                       size_t                     threads);
+template std::vector<int16_t> par_lis (const std::vector<int16_t> &arr,
+                                       const sqtype_e             &sqtype,
+                                       size_t                      threads);
+template std::vector<int32_t> par_lis (const std::vector<int32_t> &arr,
+                                       const sqtype_e             &sqtype,
+                                       size_t                      threads);
+template std::vector<int64_t> par_lis (const std::vector<int64_t> &arr,
+                                       const sqtype_e             &sqtype,
+                                       size_t                      threads);
+
+template class online_lis<int8_t, INCR>;
+template class online_lis<int16_t, INCR>;
+template class online_lis<int32_t, INCR>;
+template class online_lis<int64_t, INCR>;
+
+template class online_lis<int8_t, DECR>;
+template class online_lis<int16_t, DECR>;
+template class online_lis<int32_t, DECR>;
+template class online_lis<int64_t, DECR>;
+
+template class online_lis<int8_t, NDCR>;
+template class online_lis<int16_t, NDCR>;
+template class online_lis<int32_t, NDCR>;
+template class online_lis<int64_t, NDCR>;
+
+template class online_lis<int8_t, NICR>;
+template class online_lis<int16_t, NICR>;
+template class online_lis<int32_t, NICR>;
+template class online_lis<int64_t, NICR>;
+
 template int8_t  cnt_lis (const std::vector<int8_t> &arr);
 template int16_t cnt_lis (const std::vector<int16_t> &arr);
 template int32_t cnt_lis (const std::vector<int32_t> &arr);
 template int64_t cnt_lis (const std::vector<int64_t> &arr);
 
+template uint64_t cnt_lis_nlogn (const std::vector<int8_t> &arr,
+                                 uint64_t                   mod);
+template uint64_t cnt_lis_nlogn (const std::vector<int16_t> &arr,
+                                 uint64_t                    mod);
+template uint64_t cnt_lis_nlogn (const std::vector<int32_t> &arr,
+                                 uint64_t                    mod);
+template uint64_t cnt_lis_nlogn (const std::vector<int64_t> &arr,
+                                 uint64_t                    mod);
+
 } // namespace arr
 
 } // namespace ext
@@ -0,0 +1,71 @@
+// https://codeforces.com/blog/entry/61203
+// https://cp-algorithms.com/data_structures/sqrt_decomposition.html
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "array.hh"
+
+namespace ext
+{
+
+namespace arr
+{
+
+/** @return The distance of (x, y) along a Hilbert curve that fills a
+ * 2^lg by 2^lg grid. */
+static inline uint64_t
+hilbert_ (uint64_t x, uint64_t y, uint32_t lg)
+{
+    uint64_t d = 0;
+    for (uint64_t s = (uint64_t)1 << (lg - 1); s > 0; s >>= 1) {
+        uint64_t rx = (x & s) > 0;
+        uint64_t ry = (y & s) > 0;
+
+        d += s * s * ((3 * rx) ^ ry);
+
+        // rotate the quadrant so that the curve stays continuous
+        x &= s - 1;
+        y &= s - 1;
+
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+
+            std::swap (x, y);
+        }
+    }
+
+    return d;
+}
+
+/** @return The order in which Mo's algorithm should answer the ranges
+ * [start, end) in qs over an array of length len. */
+std::vector<size_t>
+mo_order (const std::vector<std::pair<size_t, size_t> > &qs, size_t len)
+{
+    // the endpoints go up to len, so the grid must have len + 1 cells a side
+    uint32_t lg = 1;
+    while (lg < 32 && ((uint64_t)1 << lg) <= len)
+        ++lg;
+
+    std::vector<std::pair<uint64_t, size_t> > key (qs.size ());
+    for (size_t i = 0; i < qs.size (); ++i)
+        key[i] = { hilbert_ (qs[i].first, qs[i].second, lg), i };
+
+    std::sort (key.begin (), key.end ());
+
+    std::vector<size_t> order (qs.size ());
+    for (size_t i = 0; i < qs.size (); ++i)
+        order[i] = key[i].second;
+
+    return order;
+}
+
+} // namespace arr
+
+} // namespace ext
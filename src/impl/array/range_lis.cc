@@ -0,0 +1,311 @@
+// https://arxiv.org/abs/0707.3619
+// https://arxiv.org/abs/1707.07935
+// https://codeforces.com/blog/entry/111625
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "array.hh"
+
+namespace ext
+{
+
+namespace arr
+{
+
+// sizes up to which seaweed_ combs the braid directly
+static constexpr size_t COMB_ = 64;
+
+// the top bit of a column in mul_ marks rows that come from the low half
+static constexpr uint32_t LO_ = (uint32_t)1 << 31;
+
+/** Multiplies the permutations a and b of length n as seaweed braids with
+ * the steady ant in O(n log n), so that c[i] is the column of row i in the
+ * reduced braid of a on top of b. scratch must hold 10 n + 5 log n
+ * elements. */
+static void
+mul_ (const uint32_t *a, const uint32_t *b, uint32_t *c, size_t n,
+      uint32_t *scratch)
+{
+    if (n <= 1) {
+        if (n)
+            c[0] = 0;
+        return;
+    }
+
+    const size_t m = n / 2;
+
+    uint32_t *ab = scratch, *bb = ab + n, *rows = bb + n, *cols = rows + n,
+             *cc = cols + n, *next = cc + n;
+
+    // the m rows of a whose column is in the low half go to the low product
+    for (size_t i = 0, x = 0, y = m; i < n; ++i)
+        if (a[i] < m) {
+            rows[x]  = i;
+            ab[x++] = a[i];
+        } else {
+            rows[y]  = i;
+            ab[y++] = a[i] - m;
+        }
+
+    // and so do the first m rows of b, renumbering their columns
+    uint32_t *rank = cc;
+    std::fill (rank, rank + n, 0);
+    for (size_t j = 0; j < m; ++j)
+        rank[b[j]] = 1;
+
+    for (size_t k = 0, x = 0, y = 0; k < n; ++k)
+        if (rank[k]) {
+            cols[x] = k;
+            rank[k] = x++;
+        } else {
+            cols[m + y] = k;
+            rank[k]     = y++;
+        }
+
+    for (size_t j = 0; j < n; ++j)
+        bb[j] = rank[b[j]];
+
+    mul_ (ab, bb, cc, m, next);
+    mul_ (ab + m, bb + m, cc + m, n - m, next);
+
+    // the two products as one permutation, which has every crossing the
+    // result can have and some more
+    uint32_t *row_col = ab, *col_row = bb, *ant = rows;
+    for (size_t t = 0; t < m; ++t) {
+        row_col[rows[t]]     = cols[cc[t]] | LO_;
+        col_row[cols[cc[t]]] = rows[t];
+    }
+    for (size_t t = m; t < n; ++t) {
+        row_col[rows[t]]         = cols[m + cc[t]];
+        col_row[cols[m + cc[t]]] = rows[t];
+    }
+
+    // the ant walks up from the bottom left along the border where the low
+    // points to its bottom right stop outnumbering the high points to its
+    // top left. ant[i] is its column on row i
+    int64_t d = 0;
+    size_t  k = 0;
+
+    auto extend = [&] (size_t i) {
+        for (; k < n; ++k) {
+            uint32_t r   = col_row[k];
+            int      dec = (row_col[r] & LO_) ? r >= i : r < i;
+            if (d < dec)
+                break;
+
+            d -= dec;
+        }
+    };
+
+    extend (n);
+    ant[n] = k;
+
+    for (size_t i = n; i-- > 0;) {
+        uint32_t col = row_col[i] & ~LO_;
+        d += (row_col[i] & LO_) ? col >= k : col < k;
+        extend (i);
+        ant[i] = k;
+    }
+
+    // points on the right side of the ant are kept, and the ones that
+    // crossed it are replaced by the ones it passes through
+    uint32_t *used = cc;
+    std::fill (used, used + n, 0);
+
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t col  = row_col[i] & ~LO_;
+        bool     keep = (row_col[i] & LO_) ? col < ant[i + 1] : col > ant[i];
+
+        c[i] = keep ? col : UINT32_MAX;
+        if (keep)
+            used[col] = 1;
+    }
+
+    for (size_t i = n, col = 0; i-- > 0;) {
+        if (c[i] != UINT32_MAX)
+            continue;
+
+        while (used[col])
+            ++col;
+
+        c[i] = col++;
+    }
+}
+
+/** Combs the braid of p directly in O(n^2). */
+static void
+comb_ (const uint32_t *p, uint32_t *braid, size_t n, uint32_t *scratch)
+{
+    // the seaweed on each row and column, numbered as in seaweed_, so that
+    // two of them cross once at most exactly when the larger one comes from
+    // the left
+    uint32_t *row = scratch, *col = row + n;
+    for (size_t v = 0; v < n; ++v)
+        row[v] = n - 1 - v;
+    for (size_t i = 0; i < n; ++i)
+        col[i] = n + i;
+
+    for (size_t v = 0; v < n; ++v)
+        for (size_t i = 0; i < n; ++i)
+            if (p[i] == v || row[v] > col[i])
+                std::swap (row[v], col[i]);
+
+    for (size_t i = 0; i < n; ++i)
+        braid[col[i]] = i;
+    for (size_t v = 0; v < n; ++v)
+        braid[row[v]] = 2 * n - 1 - v;
+}
+
+/** Computes the braid of the permutation p of length n by splitting its
+ * values in two, in O(n log^2 n). The seaweeds start on the left, from the
+ * bottom row up, and then on the top, and braid[s] is where seaweed s ends:
+ * on the bottom, or on the right from the bottom row up after n. scratch
+ * must hold 27 n + 5 log n elements. */
+static void
+seaweed_ (const uint32_t *p, uint32_t *braid, size_t n, uint32_t *scratch)
+{
+    if (n <= COMB_) {
+        comb_ (p, braid, n, scratch);
+        return;
+    }
+
+    const size_t h = n / 2, dn = n - h, N = 2 * n;
+
+    uint32_t *cs = scratch, *sub = cs + n, *ue = sub + N, *de = ue + N,
+             *next = de + N;
+
+    // the columns and values of the upper (low values) and lower halves
+    uint32_t *ps = ue;
+    for (size_t i = 0, x = 0, y = h; i < n; ++i)
+        if (p[i] < h) {
+            cs[x]   = i;
+            ps[x++] = p[i];
+        } else {
+            cs[y]   = i;
+            ps[y++] = p[i] - h;
+        }
+
+    seaweed_ (ps, sub, h, next);
+    seaweed_ (ps + h, sub + 2 * h, dn, next);
+
+    const uint32_t *cu = cs, *cd = cs + h;
+    const uint32_t *su = sub, *sd = sub + 2 * h;
+
+    // each half stretched over all n columns, with the seaweeds of the
+    // other half going straight through. the upper one takes [left of the
+    // lower half | left of the upper half | top] to [left of the lower half
+    // | middle | right of the upper half]
+    auto bend_u = [&] (uint32_t e) -> uint32_t {
+        return e < h ? cu[e] : n + (e - h);
+    };
+
+    std::iota (ue, ue + dn, 0);
+    for (size_t c = 0; c < n; ++c)
+        ue[dn + h + c] = dn + c;
+    for (size_t s = 0; s < h; ++s)
+        ue[dn + s] = dn + bend_u (su[s]);
+    for (size_t t = 0; t < h; ++t)
+        ue[dn + h + cu[t]] = dn + bend_u (su[h + t]);
+
+    // and the lower one takes that to [bottom | right of the lower half |
+    // right of the upper half]
+    auto bend_d = [&] (uint32_t e) -> uint32_t {
+        return e < dn ? cd[e] : n + (e - dn);
+    };
+
+    std::iota (de + dn + n, de + N, dn + n);
+    for (size_t c = 0; c < n; ++c)
+        de[dn + c] = c;
+    for (size_t s = 0; s < dn; ++s)
+        de[s] = bend_d (sd[s]);
+    for (size_t t = 0; t < dn; ++t)
+        de[dn + cd[t]] = bend_d (sd[dn + t]);
+
+    mul_ (ue, de, braid, N, next);
+}
+
+/** Ranks the elements so that a subsequence of type sqtype is an increasing
+ * subsequence of the ranks. */
+template <typename T>
+static std::vector<uint32_t>
+ranks_ (const std::vector<T> &arr, const sqtype_e &sqtype)
+{
+    const size_t n = arr.size ();
+
+    std::vector<uint32_t> idx (n);
+    std::iota (idx.begin (), idx.end (), 0);
+
+    // equal elements go from right to left when they can not both be taken
+    bool strict = sqtype == INCR || sqtype == DECR;
+    bool desc   = sqtype == DECR || sqtype == NICR;
+
+    std::sort (idx.begin (), idx.end (), [&] (uint32_t i, uint32_t j) {
+        if (arr[i] != arr[j])
+            return desc ? arr[j] < arr[i] : arr[i] < arr[j];
+
+        return strict ? i > j : i < j;
+    });
+
+    std::vector<uint32_t> rank (n);
+    for (size_t r = 0; r < n; ++r)
+        rank[idx[r]] = r;
+
+    return rank;
+}
+
+template <typename T>
+std::vector<uint32_t>
+range_lis<T>::ends_ (const std::vector<T> &arr, const sqtype_e &sqtype)
+{
+    const size_t n = arr.size ();
+
+    std::vector<uint32_t> p = ranks_ (arr, sqtype);
+    std::vector<uint32_t> braid (2 * n), scratch (27 * n + 320);
+
+    seaweed_ (p.data (), braid.data (), n, scratch.data ());
+
+    // where the seaweed from the top of each column ends on the bottom, or
+    // n if it leaves on the right
+    std::vector<uint32_t> end (n);
+    for (size_t i = 0; i < n; ++i)
+        end[i] = std::min<uint32_t> (braid[n + i], n);
+
+    return end;
+}
+
+template <typename T>
+range_lis<T>::range_lis (const std::vector<T> &arr, const sqtype_e &sqtype)
+    : end_ (ends_ (arr, sqtype))
+{
+}
+
+/** @return The length of the longest subsequence in the range [start, end)
+ * in O(log n). */
+template <typename T>
+size_t
+range_lis<T>::query (size_t start, size_t end) const
+{
+    // every seaweed from the top of the range that also leaves through its
+    // bottom is a crossing that the subsequence can not use
+    return (end - start) - end_.range_freq (start, end, 0, end);
+}
+
+/** @return The length of the array. */
+template <typename T>
+size_t
+range_lis<T>::size () const
+{
+    return end_.size ();
+}
+
+template class range_lis<int8_t>;
+template class range_lis<int16_t>;
+template class range_lis<int32_t>;
+template class range_lis<int64_t>;
+
+} // namespace arr
+
+} // namespace ext
@@ -0,0 +1,83 @@
+// https://en.wikipedia.org/wiki/Barrett_reduction
+// https://gmplib.org/~tege/division-paper.pdf
+
+#include <cstdint>
+
+#include "misc.hh"
+
+namespace ext
+{
+
+namespace modr
+{
+
+barrett::barrett (uint64_t mod)
+    : mod_ (mod), shift_ (__builtin_clzll (mod)),
+      inv_ (~(wide_t)0 / (mod << shift_) - ((wide_t)1 << 64))
+{
+}
+
+uint64_t
+barrett::reduce (wide_t x) const
+{
+    const uint64_t d = mod_ << shift_;
+
+    // x is shifted along with mod_, and its high limb stays below d
+    x <<= shift_;
+    uint64_t u1 = x >> 64, u0 = x;
+
+    // the guess is the high limb of x times the reciprocal, which is at most
+    // one off
+    wide_t   q  = (wide_t)inv_ * u1 + x;
+    uint64_t q1 = (q >> 64) + 1, q0 = q;
+    uint64_t r  = u0 - q1 * d;
+
+    if (r > q0)
+        r += d;
+    if (r >= d)
+        r -= d;
+
+    return r >> shift_;
+}
+
+uint64_t
+barrett::to (uint64_t x) const
+{
+    return reduce (x);
+}
+
+uint64_t
+barrett::from (uint64_t x) const
+{
+    return x;
+}
+
+uint64_t
+barrett::mul (uint64_t a, uint64_t b) const
+{
+    return reduce ((wide_t)a * b);
+}
+
+uint64_t
+barrett::pow (uint64_t base, uint64_t exp) const
+{
+    uint64_t b = reduce (base), ans = reduce (1);
+    for (; exp; exp >>= 1) {
+        if (exp & 1)
+            ans = mul (ans, b);
+
+        b = mul (b, b);
+    }
+
+    return ans;
+}
+
+uint64_t
+barrett::mod () const
+{
+    return mod_;
+}
+
+} // namespace modr
+
+} // namespace ext
@@ -0,0 +1,111 @@
+// https://cacr.uwaterloo.ca/hac/about/chap14.pdf, 14.6.1 and 14.6.3
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "misc.hh"
+
+namespace ext
+{
+
+namespace modr
+{
+
+template <typename Ctx>
+fixed_base<Ctx>::fixed_base (const Ctx &ctx, uint64_t base, size_t window)
+    : ctx_ (ctx), window_ (window)
+{
+    const size_t digits = (64 + window_ - 1) / window_;
+    const size_t D      = (size_t)1 << window_;
+
+    table_.resize (digits * D);
+
+    // every row starts over from 1 and steps by the first power of its digit
+    uint64_t step = ctx_.to (base);
+    for (size_t i = 0; i < digits; ++i) {
+        uint64_t *row = &table_[i * D];
+
+        row[0] = ctx_.to (1);
+        for (size_t d = 1; d < D; ++d)
+            row[d] = ctx_.mul (row[d - 1], step);
+
+        step = ctx_.mul (row[D - 1], step);
+    }
+}
+
+template <typename Ctx>
+uint64_t
+fixed_base<Ctx>::pow (uint64_t exp) const
+{
+    const size_t   digits = (64 + window_ - 1) / window_;
+    const uint64_t mask   = ((uint64_t)1 << window_) - 1;
+
+    uint64_t ans = table_[exp & mask];
+    for (size_t i = 1; i < digits; ++i)
+        ans = ctx_.mul (ans, table_[(i << window_)
+                                    + ((exp >> (i * window_)) & mask)]);
+
+    return ctx_.from (ans);
+}
+
+template <typename Ctx>
+uint64_t
+sliding_pow (const Ctx &ctx, uint64_t base, uint64_t exp, size_t window)
+{
+    if (exp == 0)
+        return ctx.from (ctx.to (1));
+
+    // odd[k] is base^(2 k + 1)
+    uint64_t odd[(size_t)1 << 7];
+    uint64_t b = ctx.to (base), sq = ctx.mul (b, b);
+
+    odd[0] = b;
+    for (size_t k = 1; k < ((size_t)1 << (window - 1)); ++k)
+        odd[k] = ctx.mul (odd[k - 1], sq);
+
+    uint64_t ans   = 0;
+    bool     first = true;
+
+    for (int i = 63 - __builtin_clzll (exp); i >= 0;) {
+        if (!((exp >> i) & 1)) {
+            ans = ctx.mul (ans, ans);
+            --i;
+            continue;
+        }
+
+        // the window runs from bit i down to the lowest one within reach
+        int j = std::max (i + 1 - (int)window, 0);
+        while (!((exp >> j) & 1))
+            ++j;
+
+        uint64_t val = (exp >> j) & (((uint64_t)2 << (i - j)) - 1);
+
+        // the leading window needs no squarings, since ans is still 1
+        if (first)
+            ans = odd[val >> 1];
+        else {
+            for (int k = i; k >= j; --k)
+                ans = ctx.mul (ans, ans);
+
+            ans = ctx.mul (ans, odd[val >> 1]);
+        }
+
+        first = false;
+        i     = j - 1;
+    }
+
+    return ctx.from (ans);
+}
+
+template class fixed_base<montgomery>;
+template class fixed_base<barrett>;
+
+template uint64_t sliding_pow (const montgomery &ctx, uint64_t base,
+                               uint64_t exp, size_t window);
+template uint64_t sliding_pow (const barrett &ctx, uint64_t base,
+                               uint64_t exp, size_t window);
+
+} // namespace modr
+
+} // namespace ext
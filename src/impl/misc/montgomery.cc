@@ -0,0 +1,116 @@
+// https://en.wikipedia.org/wiki/Montgomery_modular_multiplication
+// https://cp-algorithms.com/algebra/montgomery_multiplication.html
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "misc.hh"
+
+namespace ext
+{
+
+namespace modr
+{
+
+// the number of bases pow raises side by side
+static constexpr size_t LANES_ = 8;
+
+montgomery::montgomery (uint64_t mod) : mod_ (mod), inv_ (mod)
+{
+    // mod mod = 1 modulo 8, and every Newton step doubles the correct bits
+    for (size_t i = 0; i < 5; ++i)
+        inv_ *= 2 - mod_ * inv_;
+
+    uint64_t r = -mod_ % mod_; // 2^64 modulo mod_
+    r2_        = (wide_t)r * r % mod_;
+    one_       = r;
+}
+
+uint64_t
+montgomery::redc_ (wide_t t) const
+{
+    // m mod_ has the same low limb as t, so subtracting it clears the low
+    // limb exactly and only the high limbs are left
+    uint64_t m  = (uint64_t)t * inv_;
+    uint64_t hi = t >> 64;
+    uint64_t mh = ((wide_t)m * mod_) >> 64;
+
+    return hi >= mh ? hi - mh : hi - mh + mod_;
+}
+
+uint64_t
+montgomery::to (uint64_t x) const
+{
+    return redc_ ((wide_t)(x % mod_) * r2_);
+}
+
+uint64_t
+montgomery::from (uint64_t x) const
+{
+    return redc_ (x);
+}
+
+uint64_t
+montgomery::mul (uint64_t a, uint64_t b) const
+{
+    return redc_ ((wide_t)a * b);
+}
+
+uint64_t
+montgomery::pow (uint64_t base, uint64_t exp) const
+{
+    uint64_t b = to (base), ans = one_;
+    for (; exp; exp >>= 1) {
+        if (exp & 1)
+            ans = mul (ans, b);
+
+        b = mul (b, b);
+    }
+
+    return from (ans);
+}
+
+std::vector<uint64_t>
+montgomery::pow (const std::vector<uint64_t> &bases, uint64_t exp) const
+{
+    std::vector<uint64_t> ans (bases.size ());
+
+    const int top = exp ? 63 - __builtin_clzll (exp) : -1;
+
+    // the lanes share the exponent, so they take the same steps and each
+    // step has LANES_ independent products to overlap
+    for (size_t i = 0; i < bases.size (); i += LANES_) {
+        const size_t lanes = std::min (LANES_, bases.size () - i);
+
+        uint64_t b[LANES_], acc[LANES_];
+        for (size_t l = 0; l < LANES_; ++l) {
+            b[l]   = l < lanes ? to (bases[i + l]) : one_;
+            acc[l] = one_;
+        }
+
+        for (int bit = top; bit >= 0; --bit) {
+            for (size_t l = 0; l < LANES_; ++l)
+                acc[l] = mul (acc[l], acc[l]);
+
+            if ((exp >> bit) & 1)
+                for (size_t l = 0; l < LANES_; ++l)
+                    acc[l] = mul (acc[l], b[l]);
+        }
+
+        for (size_t l = 0; l < lanes; ++l)
+            ans[i + l] = from (acc[l]);
+    }
+
+    return ans;
+}
+
+uint64_t
+montgomery::mod () const
+{
+    return mod_;
+}
+
+} // namespace modr
+
+} // namespace ext
@@ -0,0 +1,101 @@
+// https://www.hpl.hp.com/techreports/2012/HPL-2012-68.pdf
+// a sequence lock over the bottom-up segment tree in segment_tree.cc
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+#include "tree.hh"
+
+namespace ext
+{
+
+namespace segtr
+{
+
+template <typename T>
+concurrent_tree<T>::concurrent_tree (
+    size_t len, const T dft,
+    std::function<T (const T &, const T &)> const &combine)
+    : DEFAULT_ (dft), tree_ (len << 1), len_ (len), seq_ (0),
+      combine_ (combine)
+{
+    for (std::atomic<T> &node : tree_)
+        node.store (dft, std::memory_order_relaxed);
+}
+
+/** @return A query of the range [start, end) without a snapshot check. */
+template <typename T>
+T
+concurrent_tree<T>::query_ (size_t start, size_t end) const
+{
+    T ans = DEFAULT_;
+    for (start += len_, end += len_; start < end; start >>= 1, end >>= 1) {
+        if (start & 1)
+            ans = combine_ (
+                ans, tree_[start++].load (std::memory_order_relaxed));
+
+        if (end & 1)
+            ans = combine_ (ans,
+                            tree_[--end].load (std::memory_order_relaxed));
+    }
+
+    return ans;
+}
+
+/** Sets the value at idx to val. */
+template <typename T>
+void
+concurrent_tree<T>::set (size_t idx, T val)
+{
+    std::lock_guard<std::mutex> lock (write_);
+
+    // mark the write as in progress. the fence keeps the stores below from
+    // becoming visible before the odd sequence number
+    uint64_t seq = seq_.load (std::memory_order_relaxed);
+    seq_.store (seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    idx += len_;
+    tree_[idx].store (val, std::memory_order_relaxed);
+
+    for (; idx > 1; idx >>= 1) {
+        T res = combine_ (tree_[idx].load (std::memory_order_relaxed),
+                          tree_[idx ^ 1].load (std::memory_order_relaxed));
+        tree_[idx >> 1].store (res, std::memory_order_relaxed);
+    }
+
+    seq_.store (seq + 2, std::memory_order_release);
+}
+
+/** @return A query of the range [start, end) on a consistent snapshot. */
+template <typename T>
+T
+concurrent_tree<T>::query (size_t start, size_t end) const
+{
+    for (;;) {
+        uint64_t before = seq_.load (std::memory_order_acquire);
+
+        // a write is in progress, so whatever we read would be discarded
+        if (before & 1)
+            continue;
+
+        T ans = query_ (start, end);
+
+        // the fence keeps the loads in query_ from moving past the second
+        // read of the sequence number
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (seq_.load (std::memory_order_relaxed) == before)
+            return ans;
+    }
+}
+
+template class concurrent_tree<int32_t>;
+template class concurrent_tree<int64_t>;
+template class concurrent_tree<uint32_t>;
+template class concurrent_tree<uint64_t>;
+
+} // namespace segtr
+
+} // namespace ext
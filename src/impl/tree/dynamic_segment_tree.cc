@@ -0,0 +1,226 @@
+// https://usaco.guide/plat/sparse-segtree?lang=cpp
+// a lazy segment tree whose nodes are allocated from a pool on first use so
+// that coordinates can span the whole 64 bit range
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "tree.hh"
+
+namespace ext
+{
+
+namespace dyn_segtr
+{
+
+using namespace lz_segtr;
+
+/** @return The index of a new node in the pool. */
+template <typename T>
+inline uint32_t
+tree<T>::alloc_ ()
+{
+    // children are 32 bit indices to keep the nodes small
+    assert (node_.size () < UINT32_MAX);
+
+    node_.push_back (node_t{ DEFAULT_, query_t<T> (), 0, 0 });
+    used_.push_back (false);
+    return node_.size () - 1;
+}
+
+template <typename T>
+inline void
+tree<T>::pushup_ (uint32_t pos)
+{
+    // a missing child covers a range that still only holds DEFAULT_
+    const node_t &nd = node_[pos];
+    T lv = nd.lc ? node_[nd.lc].val : DEFAULT_;
+    T rv = nd.rc ? node_[nd.rc].val : DEFAULT_;
+
+    node_[pos].val = combine_ (lv, rv);
+    used_[pos]     = used_[nd.lc] || used_[nd.rc];
+}
+
+template <typename T>
+void
+tree<T>::apply_ (uint32_t pos, uint64_t len, const query_t<T> &q)
+{
+    node_t &nd = node_[pos];
+
+    if (q.type == ADD) {
+        if (nd.lazy.type != SET)
+            nd.lazy = query_t<T>{ ADD, nd.lazy.val + q.val };
+        else
+            nd.lazy = query_t<T>{ SET, nd.lazy.val + q.val };
+
+        // for MIN and MAX, a range that was never set holds the identity,
+        // which adding to would overflow
+        if (type_ == SUM || used_[pos])
+            nd.val += upd_upstream_ (q.val, len);
+    } else if (q.type == SET) {
+        nd.val     = upd_upstream_ (q.val, len);
+        nd.lazy    = q;
+        used_[pos] = true;
+    }
+}
+
+template <typename T>
+void
+tree<T>::pushdown_ (uint32_t pos, uint64_t l, uint64_t mid, uint64_t r)
+{
+    if (node_[pos].lazy.type == NONE || l == r)
+        return;
+
+    // the pending tag needs somewhere to go, so both children are created.
+    // alloc_ may reallocate the pool, so no references are held across it
+    if (!node_[pos].lc) {
+        uint32_t c    = alloc_ ();
+        node_[pos].lc = c;
+    }
+
+    if (!node_[pos].rc) {
+        uint32_t c    = alloc_ ();
+        node_[pos].rc = c;
+    }
+
+    query_t<T> q = node_[pos].lazy;
+    apply_ (node_[pos].lc, mid - l + 1, q);
+    apply_ (node_[pos].rc, r - mid, q);
+
+    node_[pos].lazy = query_t<T>{ NONE, 0 };
+}
+
+template <typename T>
+tree<T>::tree (uint64_t lb, uint64_t rb, T dft, treeop_e type, size_t cap)
+    : DEFAULT_ (dft), lb_ (lb), rb_ (rb), type_ (type)
+{
+    switch (type) {
+        case SUM:
+            combine_ = [] (const T &x, const T &y) { return x + y; };
+            // len is taken modulo 2^64, so the whole 64 bit range has length
+            // 0, which is also its true length modulo 2^64. the product is
+            // formed unsigned so that it wraps instead of overflowing
+            upd_upstream_ = [] (const T &val, uint64_t len) {
+                return (T)((uint64_t)val * len);
+            };
+            break;
+        case MIN:
+            combine_ = [] (const T &x, const T &y) { return std::min (x, y); };
+            upd_upstream_ = [] (const T &val, uint64_t) { return val; };
+            break;
+        case MAX:
+            combine_ = [] (const T &x, const T &y) { return std::max (x, y); };
+            upd_upstream_ = [] (const T &val, uint64_t) { return val; };
+            break;
+    }
+
+    node_.reserve (std::max<size_t> (cap, 2));
+    used_.reserve (std::max<size_t> (cap, 2));
+
+    // null sentinel and root
+    alloc_ ();
+    alloc_ ();
+}
+
+template <typename T>
+void
+tree<T>::upd_ (uint64_t start, uint64_t end, const query_t<T> &q,
+               uint32_t pos_, uint64_t l_, uint64_t r_)
+{
+    if (start > r_ || end < l_)
+        return;
+
+    if (start <= l_ && r_ <= end) {
+        apply_ (pos_, r_ - l_ + 1, q);
+        return;
+    }
+
+    uint64_t mid = l_ + ((r_ - l_) >> 1);
+    pushdown_ (pos_, l_, mid, r_);
+
+    // only the children that intersect [start, end] are created, so a point
+    // update allocates a single path
+    if (start <= mid) {
+        if (!node_[pos_].lc) {
+            uint32_t c     = alloc_ ();
+            node_[pos_].lc = c;
+        }
+        upd_ (start, end, q, node_[pos_].lc, l_, mid);
+    }
+
+    if (end > mid) {
+        if (!node_[pos_].rc) {
+            uint32_t c     = alloc_ ();
+            node_[pos_].rc = c;
+        }
+        upd_ (start, end, q, node_[pos_].rc, mid + 1, r_);
+    }
+
+    pushup_ (pos_);
+}
+
+template <typename T>
+T
+tree<T>::query_ (uint64_t start, uint64_t end, uint32_t pos_, uint64_t l_,
+                 uint64_t r_)
+{
+    // missing nodes only contain DEFAULT_, which is the identity
+    if (!pos_ || start > r_ || end < l_)
+        return DEFAULT_;
+
+    if (start <= l_ && end >= r_)
+        return node_[pos_].val;
+
+    // an untagged node can be read without allocating anything
+    uint64_t mid = l_ + ((r_ - l_) >> 1);
+    pushdown_ (pos_, l_, mid, r_);
+
+    uint32_t lc = node_[pos_].lc;
+    uint32_t rc = node_[pos_].rc;
+
+    return combine_ (query_ (start, end, lc, l_, mid),
+                     query_ (start, end, rc, mid + 1, r_));
+}
+
+/** Sets the value at idx to val. */
+template <typename T>
+void
+tree<T>::set (uint64_t idx, T val)
+{
+    upd_ (idx, idx, query_t<T>{ SET, val }, 1, lb_, rb_);
+}
+
+/** Adds or sets a value to the range of elements [start, end]. */
+template <typename T>
+void
+tree<T>::upd (uint64_t start, uint64_t end, T val, qtype_e qtype)
+{
+    upd_ (start, end, query_t<T>{ qtype, val }, 1, lb_, rb_);
+}
+
+/** @return A query of the range [start, end]. */
+template <typename T>
+T
+tree<T>::query (uint64_t start, uint64_t end)
+{
+    return query_ (start, end, 1, lb_, rb_);
+}
+
+/** @return The number of nodes that have been allocated. */
+template <typename T>
+size_t
+tree<T>::size () const
+{
+    return node_.size () - 1;
+}
+
+template class tree<int32_t>;
+template class tree<int64_t>;
+template class tree<uint32_t>;
+template class tree<uint64_t>;
+
+} // namespace dyn_segtr
+
+} // namespace ext
@@ -0,0 +1,133 @@
+// https://usaco.guide/CPH.pdf#page=96
+// https://cp-algorithms.com/data_structures/fenwick.html
+
+#include <cstdint>
+#include <vector>
+
+#include "tree.hh"
+
+namespace ext
+{
+
+namespace fwtr
+{
+
+template <typename T>
+tree<T>::tree (size_t len) : tree_ (len + 1, 0), len_ (len)
+{
+}
+
+/** Builds the tree from arr in O(n). */
+template <typename T>
+tree<T>::tree (const std::vector<T> &arr)
+    : tree_ (arr.size () + 1, 0), len_ (arr.size ())
+{
+    // each node pushes its finished sum to the next node that covers it
+    for (size_t i = 1; i <= len_; ++i) {
+        tree_[i] += arr[i - 1];
+
+        size_t nxt = i + (i & -i);
+        if (nxt <= len_)
+            tree_[nxt] += tree_[i];
+    }
+}
+
+/** Adds val to the element at idx. */
+template <typename T>
+void
+tree<T>::add (size_t idx, T val)
+{
+    for (++idx; idx <= len_; idx += idx & -idx)
+        tree_[idx] += val;
+}
+
+/** @return The sum of the range [0, end). */
+template <typename T>
+T
+tree<T>::prefix (size_t end) const
+{
+    T ans = 0;
+    for (; end > 0; end -= end & -end)
+        ans += tree_[end];
+
+    return ans;
+}
+
+/** @return The sum of the range [start, end). */
+template <typename T>
+T
+tree<T>::query (size_t start, size_t end) const
+{
+    return prefix (end) - prefix (start);
+}
+
+/** @return The smallest idx such that the sum of [0, idx] is at least val, or
+ * len if there is none. All elements must be non-negative. */
+template <typename T>
+size_t
+tree<T>::lower_bound (T val) const
+{
+    if (len_ == 0)
+        return 0;
+
+    // descend from the highest power of two, taking a node whenever the sum
+    // would still stay below val. pos ends at the last prefix that does
+    size_t pos  = 0;
+    size_t step = (size_t)1 << (63 - __builtin_clzll (len_));
+
+    for (; step > 0; step >>= 1) {
+        if (pos + step <= len_ && tree_[pos + step] < val) {
+            pos += step;
+            val -= tree_[pos];
+        }
+    }
+
+    return pos;
+}
+
+template <typename T>
+range_tree<T>::range_tree (size_t len)
+    : add_ (len + 1), sub_ (len + 1), len_ (len)
+{
+}
+
+/** Adds val to every element in the range [start, end). */
+template <typename T>
+void
+range_tree<T>::upd (size_t start, size_t end, T val)
+{
+    add_.add (start, val);
+    add_.add (end, -val);
+    sub_.add (start, val * (T)start);
+    sub_.add (end, -val * (T)end);
+}
+
+/** @return The sum of the range [0, end). */
+template <typename T>
+T
+range_tree<T>::prefix (size_t end) const
+{
+    return add_.prefix (end) * (T)end - sub_.prefix (end);
+}
+
+/** @return The sum of the range [start, end). */
+template <typename T>
+T
+range_tree<T>::query (size_t start, size_t end) const
+{
+    return prefix (end) - prefix (start);
+}
+
+template class tree<int32_t>;
+template class tree<int64_t>;
+template class tree<uint32_t>;
+template class tree<uint64_t>;
+
+template class range_tree<int32_t>;
+template class range_tree<int64_t>;
+template class range_tree<uint32_t>;
+template class range_tree<uint64_t>;
+
+} // namespace fwtr
+
+} // namespace ext
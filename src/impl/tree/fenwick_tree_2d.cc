@@ -0,0 +1,160 @@
+// https://cp-algorithms.com/data_structures/fenwick.html
+// https://usaco.guide/plat/2DRQ?lang=cpp#offline-2d-bit
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "tree.hh"
+
+namespace ext
+{
+
+namespace fwtr
+{
+
+template <typename T>
+tree_2d<T>::tree_2d (size_t rows, size_t cols)
+    : tree_ ((rows + 1) * (cols + 1), 0), rows_ (rows), cols_ (cols)
+{
+}
+
+/** Adds val to the element at (row, col). */
+template <typename T>
+void
+tree_2d<T>::add (size_t row, size_t col, T val)
+{
+    for (size_t i = row + 1; i <= rows_; i += i & -i) {
+        T *line = &tree_[i * (cols_ + 1)];
+        for (size_t j = col + 1; j <= cols_; j += j & -j)
+            line[j] += val;
+    }
+}
+
+/** @return The sum of the rectangle [0, row) x [0, col). */
+template <typename T>
+T
+tree_2d<T>::prefix (size_t row, size_t col) const
+{
+    T ans = 0;
+    for (size_t i = row; i > 0; i -= i & -i) {
+        const T *line = &tree_[i * (cols_ + 1)];
+        for (size_t j = col; j > 0; j -= j & -j)
+            ans += line[j];
+    }
+
+    return ans;
+}
+
+/** @return The sum of the rectangle [r0, r1) x [c0, c1). */
+template <typename T>
+T
+tree_2d<T>::query (size_t r0, size_t c0, size_t r1, size_t c1) const
+{
+    return prefix (r1, c1) - prefix (r0, c1) - prefix (r1, c0)
+           + prefix (r0, c0);
+}
+
+template <typename T>
+sparse_2d<T>::sparse_2d (
+    const std::vector<std::pair<uint64_t, uint64_t> > &pts)
+{
+    xs_.reserve (pts.size ());
+    for (const auto &[x, y] : pts)
+        xs_.push_back (x);
+
+    std::sort (xs_.begin (), xs_.end ());
+    xs_.erase (std::unique (xs_.begin (), xs_.end ()), xs_.end ());
+
+    size_t nx = xs_.size ();
+
+    // every point belongs to the log n nodes that add would visit
+    std::vector<std::vector<uint64_t> > node (nx + 1);
+    for (const auto &[x, y] : pts) {
+        size_t i
+            = std::lower_bound (xs_.begin (), xs_.end (), x) - xs_.begin ();
+        for (++i; i <= nx; i += i & -i)
+            node[i].push_back (y);
+    }
+
+    off_.assign (nx + 1, 0);
+    for (size_t i = 1; i <= nx; ++i) {
+        std::sort (node[i].begin (), node[i].end ());
+        node[i].erase (std::unique (node[i].begin (), node[i].end ()),
+                       node[i].end ());
+
+        off_[i] = off_[i - 1] + node[i].size ();
+    }
+
+    ys_.reserve (off_[nx]);
+    for (size_t i = 1; i <= nx; ++i)
+        ys_.insert (ys_.end (), node[i].begin (), node[i].end ());
+
+    tree_.assign (off_[nx] + nx, 0);
+}
+
+/** Adds val to the point (x, y), which must have been passed to the
+ * constructor. */
+template <typename T>
+void
+sparse_2d<T>::add (uint64_t x, uint64_t y, T val)
+{
+    size_t nx = xs_.size ();
+    size_t i  = std::lower_bound (xs_.begin (), xs_.end (), x) - xs_.begin ();
+
+    for (++i; i <= nx; i += i & -i) {
+        const uint64_t *lo = ys_.data () + off_[i - 1];
+        const uint64_t *hi = ys_.data () + off_[i];
+
+        size_t cnt = hi - lo;
+        T     *bit = &tree_[off_[i - 1] + i - 1];
+
+        for (size_t j = std::lower_bound (lo, hi, y) - lo + 1; j <= cnt;
+             j += j & -j)
+            bit[j] += val;
+    }
+}
+
+/** @return The sum of the points in [0, x) x [0, y). */
+template <typename T>
+T
+sparse_2d<T>::prefix (uint64_t x, uint64_t y) const
+{
+    T ans = 0;
+
+    size_t i = std::lower_bound (xs_.begin (), xs_.end (), x) - xs_.begin ();
+    for (; i > 0; i -= i & -i) {
+        const uint64_t *lo  = ys_.data () + off_[i - 1];
+        const uint64_t *hi  = ys_.data () + off_[i];
+        const T        *bit = &tree_[off_[i - 1] + i - 1];
+
+        for (size_t j = std::lower_bound (lo, hi, y) - lo; j > 0; j -= j & -j)
+            ans += bit[j];
+    }
+
+    return ans;
+}
+
+/** @return The sum of the points in [x0, x1) x [y0, y1). */
+template <typename T>
+T
+sparse_2d<T>::query (uint64_t x0, uint64_t y0, uint64_t x1, uint64_t y1) const
+{
+    return prefix (x1, y1) - prefix (x0, y1) - prefix (x1, y0)
+           + prefix (x0, y0);
+}
+
+template class tree_2d<int32_t>;
+template class tree_2d<int64_t>;
+template class tree_2d<uint32_t>;
+template class tree_2d<uint64_t>;
+
+template class sparse_2d<int32_t>;
+template class sparse_2d<int64_t>;
+template class sparse_2d<uint32_t>;
+template class sparse_2d<uint64_t>;
+
+} // namespace fwtr
+
+} // namespace ext
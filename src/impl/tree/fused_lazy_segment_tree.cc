@@ -0,0 +1,178 @@
+// iterative_lazy_segment_tree.cc with the aggregate and tag of each internal
+// node stored together
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "tree.hh"
+
+namespace ext
+{
+
+namespace lz_segtr
+{
+
+template <typename T>
+inline T
+fused_tree<T>::combine_ (const T &x, const T &y) const
+{
+    switch (type_) {
+        case MIN:
+            return std::min (x, y);
+        case MAX:
+            return std::max (x, y);
+        default:
+            return x + y;
+    }
+}
+
+template <typename T>
+inline T &
+fused_tree<T>::val_ (size_t pos)
+{
+    return pos < size_ ? node_[pos].val : leaf_[pos - size_];
+}
+
+template <typename T>
+inline void
+fused_tree<T>::pushup_ (size_t pos)
+{
+    node_[pos].val = combine_ (val_ (pos << 1), val_ ((pos << 1) + 1));
+}
+
+template <typename T>
+inline void
+fused_tree<T>::apply_ (size_t pos, const T &val, bool set)
+{
+    T len = (T)1 << (log_ - (63 - __builtin_clzll (pos)));
+
+    // SUM: val * len
+    // MIN: val
+    // MAX: val
+    T upstream = type_ == SUM ? val * len : val;
+
+    if (pos >= size_) {
+        T &leaf = leaf_[pos - size_];
+        leaf    = set ? upstream : leaf + upstream;
+        return;
+    }
+
+    node_t &nd = node_[pos];
+    if (set) {
+        nd.val    = upstream;
+        nd.tag    = val;
+        set_[pos] = true;
+    } else {
+        // adding to a set tag keeps it a set tag
+        nd.val += upstream;
+        nd.tag += val;
+    }
+}
+
+template <typename T>
+inline void
+fused_tree<T>::pushdown_ (size_t pos)
+{
+    node_t &nd  = node_[pos];
+    bool    set = set_[pos];
+
+    if (!set && nd.tag == 0)
+        return;
+
+    apply_ (pos << 1, nd.tag, set);
+    apply_ ((pos << 1) + 1, nd.tag, set);
+
+    nd.tag    = 0;
+    set_[pos] = false;
+}
+
+template <typename T>
+fused_tree<T>::fused_tree (size_t len, T dft, const std::vector<T> &arr,
+                           treeop_e type)
+    : DEFAULT_ (dft), len_ (len), type_ (type)
+{
+    log_  = len <= 1 ? 0 : 64 - __builtin_clzll (len - 1);
+    size_ = (size_t)1 << log_;
+
+    node_.assign (size_, node_t{ dft, 0 });
+    set_.assign (size_, false);
+    leaf_.assign (size_, dft);
+
+    std::copy (arr.begin (), arr.begin () + len, leaf_.begin ());
+
+    for (size_t i = size_ - 1; i > 0; --i)
+        pushup_ (i);
+}
+
+/** Adds or sets a value to the range of elements [start, end]. */
+template <typename T>
+void
+fused_tree<T>::upd (size_t start, size_t end, T val, qtype_e qtype)
+{
+    size_t l   = start + size_;
+    size_t r   = end + size_ + 1;
+    bool   set = qtype == SET;
+
+    for (size_t i = log_; i > 0; --i) {
+        if (((l >> i) << i) != l)
+            pushdown_ (l >> i);
+
+        if (((r >> i) << i) != r)
+            pushdown_ ((r - 1) >> i);
+    }
+
+    for (size_t lo = l, hi = r; lo < hi; lo >>= 1, hi >>= 1) {
+        if (lo & 1)
+            apply_ (lo++, val, set);
+
+        if (hi & 1)
+            apply_ (--hi, val, set);
+    }
+
+    for (size_t i = 1; i <= log_; ++i) {
+        if (((l >> i) << i) != l)
+            pushup_ (l >> i);
+
+        if (((r >> i) << i) != r)
+            pushup_ ((r - 1) >> i);
+    }
+}
+
+/** @return A query of the range [start, end]. */
+template <typename T>
+T
+fused_tree<T>::query (size_t start, size_t end)
+{
+    size_t l = start + size_;
+    size_t r = end + size_ + 1;
+
+    for (size_t i = log_; i > 0; --i) {
+        if (((l >> i) << i) != l)
+            pushdown_ (l >> i);
+
+        if (((r >> i) << i) != r)
+            pushdown_ ((r - 1) >> i);
+    }
+
+    T lans = DEFAULT_;
+    T rans = DEFAULT_;
+    for (; l < r; l >>= 1, r >>= 1) {
+        if (l & 1)
+            lans = combine_ (lans, val_ (l++));
+
+        if (r & 1)
+            rans = combine_ (val_ (--r), rans);
+    }
+
+    return combine_ (lans, rans);
+}
+
+template class fused_tree<int32_t>;
+template class fused_tree<int64_t>;
+template class fused_tree<uint32_t>;
+template class fused_tree<uint64_t>;
+
+} // namespace lz_segtr
+
+} // namespace ext
@@ -0,0 +1,167 @@
+// https://codeforces.com/blog/entry/18051
+// the same operations as lazy_segment_tree.cc without recursion
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "tree.hh"
+
+namespace ext
+{
+
+namespace lz_segtr
+{
+
+template <typename T>
+inline T
+iter_tree<T>::combine_ (const T &x, const T &y) const
+{
+    switch (type_) {
+        case MIN:
+            return std::min (x, y);
+        case MAX:
+            return std::max (x, y);
+        default:
+            return x + y;
+    }
+}
+
+template <typename T>
+inline void
+iter_tree<T>::pushup_ (size_t pos)
+{
+    tree_[pos] = combine_ (tree_[pos << 1], tree_[(pos << 1) + 1]);
+}
+
+template <typename T>
+inline void
+iter_tree<T>::apply_ (size_t pos, const query_t<T> &q)
+{
+    // a node at depth d covers 2^(log - d) leaves
+    T len = (T)1 << (log_ - (63 - __builtin_clzll (pos)));
+
+    // SUM: q.val * len
+    // MIN: q.val
+    // MAX: q.val
+    T upstream = type_ == SUM ? q.val * len : q.val;
+
+    if (q.type == ADD)
+        tree_[pos] += upstream;
+    else
+        tree_[pos] = upstream;
+
+    if (pos >= size_)
+        return;
+
+    if (q.type == SET || lazy_[pos].type == NONE)
+        lazy_[pos] = q;
+    else
+        lazy_[pos].val += q.val;
+}
+
+template <typename T>
+inline void
+iter_tree<T>::pushdown_ (size_t pos)
+{
+    if (lazy_[pos].type == NONE)
+        return;
+
+    apply_ (pos << 1, lazy_[pos]);
+    apply_ ((pos << 1) + 1, lazy_[pos]);
+
+    lazy_[pos] = query_t<T>{ NONE, 0 };
+}
+
+template <typename T>
+iter_tree<T>::iter_tree (size_t len, T dft, const std::vector<T> &arr,
+                         treeop_e type)
+    : DEFAULT_ (dft), len_ (len), type_ (type)
+{
+    log_  = len <= 1 ? 0 : 64 - __builtin_clzll (len - 1);
+    size_ = (size_t)1 << log_;
+
+    tree_.assign (size_ << 1, dft);
+    lazy_.assign (size_, query_t<T> ());
+
+    std::copy (arr.begin (), arr.begin () + len, tree_.begin () + size_);
+
+    for (size_t i = size_ - 1; i > 0; --i)
+        pushup_ (i);
+}
+
+/** Adds or sets a value to the range of elements [start, end]. */
+template <typename T>
+void
+iter_tree<T>::upd (size_t start, size_t end, T val, qtype_e qtype)
+{
+    size_t l = start + size_;
+    size_t r = end + size_ + 1;
+
+    // push the tags on the paths to both boundaries. a node on the path only
+    // needs it if the boundary does not line up with the start of the node
+    for (size_t i = log_; i > 0; --i) {
+        if (((l >> i) << i) != l)
+            pushdown_ (l >> i);
+
+        if (((r >> i) << i) != r)
+            pushdown_ ((r - 1) >> i);
+    }
+
+    query_t<T> q{ qtype, val };
+    for (size_t lo = l, hi = r; lo < hi; lo >>= 1, hi >>= 1) {
+        if (lo & 1)
+            apply_ (lo++, q);
+
+        if (hi & 1)
+            apply_ (--hi, q);
+    }
+
+    // recompute the nodes above the boundaries
+    for (size_t i = 1; i <= log_; ++i) {
+        if (((l >> i) << i) != l)
+            pushup_ (l >> i);
+
+        if (((r >> i) << i) != r)
+            pushup_ ((r - 1) >> i);
+    }
+}
+
+/** @return A query of the range [start, end]. */
+template <typename T>
+T
+iter_tree<T>::query (size_t start, size_t end)
+{
+    size_t l = start + size_;
+    size_t r = end + size_ + 1;
+
+    for (size_t i = log_; i > 0; --i) {
+        if (((l >> i) << i) != l)
+            pushdown_ (l >> i);
+
+        if (((r >> i) << i) != r)
+            pushdown_ ((r - 1) >> i);
+    }
+
+    // keep the left and right halves apart so that they combine in order
+    T lans = DEFAULT_;
+    T rans = DEFAULT_;
+    for (; l < r; l >>= 1, r >>= 1) {
+        if (l & 1)
+            lans = combine_ (lans, tree_[l++]);
+
+        if (r & 1)
+            rans = combine_ (tree_[--r], rans);
+    }
+
+    return combine_ (lans, rans);
+}
+
+template class iter_tree<int32_t>;
+template class iter_tree<int64_t>;
+template class iter_tree<uint32_t>;
+template class iter_tree<uint64_t>;
+
+} // namespace lz_segtr
+
+} // namespace ext
@@ -2,6 +2,8 @@
 // based on problem cses 1735: https://cses.fi/problemset/task/1735/
 
 #include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
 #include "tree.hh"
@@ -16,13 +18,10 @@ template <typename T>
 T
 tree<T>::next_p2_ (T x)
 {
-    if (x == 1)
+    if (x <= 1)
         return 1;
 
-    if (sizeof (T) <= 32)
-        return 1 << (sizeof (T) - __builtin_clzl (x - 1));
-    else
-        return 1 << (sizeof (T) - __builtin_clzll (x - 1));
+    return (T)1 << (64 - __builtin_clzll ((uint64_t)x - 1));
 }
 
 template <typename T>
@@ -90,7 +89,7 @@ tree<T>::build_ (size_t pos, size_t lb, size_t rb, const std::vector<T> &arr)
 template <typename T>
 tree<T>::tree (size_t len, T dft, std::vector<T> arr, treeop_e type)
     : DEFAULT_ (dft), tree_ (next_p2_ (len) << 1, dft),
-      lazy_ (next_p2_ (len), query_t<T> ()), len_ (len)
+      lazy_ (next_p2_ (len) << 1, query_t<T> ()), len_ (len), type_ (type)
 {
     switch (type) {
         case SUM:
@@ -168,6 +167,74 @@ tree<T>::query_ (size_t start, size_t end, size_t pos_, size_t l_, size_t r_)
                      query_ (start, end, lc + 1, mid + 1, r_));
 }
 
+template <typename T>
+size_t
+tree<T>::max_right_ (size_t start, std::function<bool (const T &)> const &pred,
+                     T *acc, size_t pos_, size_t l_, size_t r_)
+{
+    // len_ means that the answer is not inside [lb, rb]
+    if (r_ < start)
+        return len_;
+
+    // if [lb, rb] is completely inside [start, len), try to take all of it
+    if (start <= l_) {
+        T nxt = combine_ (*acc, tree_[pos_]);
+
+        if (pred (nxt)) {
+            *acc = nxt;
+            return len_;
+        }
+
+        if (l_ == r_)
+            return l_;
+    }
+
+    size_t mid = l_ + ((r_ - l_) >> 1);
+    pushdown_ (pos_, l_, mid, r_);
+
+    size_t lc  = pos_ << 1;
+    size_t ans = max_right_ (start, pred, acc, lc, l_, mid);
+
+    if (ans != len_)
+        return ans;
+
+    return max_right_ (start, pred, acc, lc + 1, mid + 1, r_);
+}
+
+template <typename T>
+size_t
+tree<T>::min_left_ (size_t end, std::function<bool (const T &)> const &pred,
+                    T *acc, size_t pos_, size_t l_, size_t r_)
+{
+    // SIZE_MAX means that the answer is not inside [lb, rb]
+    if (l_ > end)
+        return SIZE_MAX;
+
+    // if [lb, rb] is completely inside [0, end], try to take all of it
+    if (r_ <= end) {
+        T nxt = combine_ (tree_[pos_], *acc);
+
+        if (pred (nxt)) {
+            *acc = nxt;
+            return SIZE_MAX;
+        }
+
+        if (l_ == r_)
+            return l_ + 1;
+    }
+
+    size_t mid = l_ + ((r_ - l_) >> 1);
+    pushdown_ (pos_, l_, mid, r_);
+
+    size_t lc  = pos_ << 1;
+    size_t ans = min_left_ (end, pred, acc, lc + 1, mid + 1, r_);
+
+    if (ans != SIZE_MAX)
+        return ans;
+
+    return min_left_ (end, pred, acc, lc, l_, mid);
+}
+
 template <typename T>
 inline void
 tree<T>::upd (size_t start, size_t end, T val, qtype_e qtype)
@@ -182,6 +249,33 @@ tree<T>::query (size_t start, size_t end)
     return query_ (start, end, 1, 0, len_ - 1);
 }
 
+/** Descends the tree once in O(log n). pred must be monotone and hold for the
+ * default value.
+ * @return The first idx such that pred (query (start, idx)) does not hold, or
+ * len if there is none. */
+template <typename T>
+size_t
+tree<T>::max_right (size_t start, std::function<bool (const T &)> const &pred)
+{
+    T acc = DEFAULT_;
+    return max_right_ (start, pred, &acc, 1, 0, len_ - 1);
+}
+
+/** Descends the tree once in O(log n). pred must be monotone and hold for the
+ * default value.
+ * @return The smallest idx such that pred (query (idx, end)) holds, or end + 1
+ * if there is none. */
+template <typename T>
+size_t
+tree<T>::min_left (size_t end, std::function<bool (const T &)> const &pred)
+{
+    T      acc = DEFAULT_;
+    size_t ans = min_left_ (end, pred, &acc, 1, 0, len_ - 1);
+
+    // every element of [0, end] could be taken
+    return ans == SIZE_MAX ? 0 : ans;
+}
+
 template class tree<int32_t>;
 template class tree<int64_t>;
 template class tree<uint32_t>;
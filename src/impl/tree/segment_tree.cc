@@ -57,6 +57,111 @@ tree<T>::query (size_t start, size_t end)
     return ans;
 }
 
+/** Descends the tree once in O(log n). pred must be monotone and hold for the
+ * default value.
+ * @return The largest end such that pred (query (start, end)) holds. */
+template <typename T>
+size_t
+tree<T>::max_right (size_t start, std::function<bool (const T &)> const &pred)
+{
+    // collect the nodes that query (start, len) would visit, from left to
+    // right. there are at most two per level
+    size_t nodes[128];
+    size_t rnodes[64];
+    size_t cnt  = 0;
+    size_t rcnt = 0;
+
+    for (size_t l = start + len_, r = len_ << 1; l < r; l >>= 1, r >>= 1) {
+        if (l & 1)
+            nodes[cnt++] = l++;
+
+        if (r & 1)
+            rnodes[rcnt++] = --r;
+    }
+
+    while (rcnt)
+        nodes[cnt++] = rnodes[--rcnt];
+
+    T acc = DEFAULT_;
+    for (size_t i = 0; i < cnt; ++i) {
+        size_t pos = nodes[i];
+        T      nxt = combine_ (acc, tree_[pos]);
+
+        if (pred (nxt)) {
+            acc = nxt;
+            continue;
+        }
+
+        // the answer is inside this node. walk down to the leaf, going right
+        // whenever the whole left child can be taken
+        while (pos < len_) {
+            pos <<= 1;
+            nxt = combine_ (acc, tree_[pos]);
+
+            if (pred (nxt)) {
+                acc = nxt;
+                ++pos;
+            }
+        }
+
+        return pos - len_;
+    }
+
+    return len_;
+}
+
+/** Descends the tree once in O(log n). pred must be monotone and hold for the
+ * default value.
+ * @return The smallest start such that pred (query (start, end)) holds. */
+template <typename T>
+size_t
+tree<T>::min_left (size_t end, std::function<bool (const T &)> const &pred)
+{
+    // collect the nodes that query (0, end) would visit, from right to left
+    size_t nodes[128];
+    size_t lnodes[64];
+    size_t cnt  = 0;
+    size_t lcnt = 0;
+
+    for (size_t l = len_, r = end + len_; l < r; l >>= 1, r >>= 1) {
+        if (l & 1)
+            lnodes[lcnt++] = l++;
+
+        if (r & 1)
+            nodes[cnt++] = --r;
+    }
+
+    while (lcnt)
+        nodes[cnt++] = lnodes[--lcnt];
+
+    T acc = DEFAULT_;
+    for (size_t i = 0; i < cnt; ++i) {
+        size_t pos = nodes[i];
+        T      nxt = combine_ (tree_[pos], acc);
+
+        if (pred (nxt)) {
+            acc = nxt;
+            continue;
+        }
+
+        // mirrored descent: go left whenever the whole right child can be
+        // taken
+        while (pos < len_) {
+            pos = (pos << 1) + 1;
+            nxt = combine_ (tree_[pos], acc);
+
+            if (pred (nxt)) {
+                acc = nxt;
+                --pos;
+            }
+        }
+
+        return pos + 1 - len_;
+    }
+
+    return 0;
+}
+
 template class tree<int32_t>;
 template class tree<int64_t>;
 template class tree<uint32_t>;
@@ -0,0 +1,318 @@
+// https://codeforces.com/blog/entry/57319
+// based on problem hdu 5306 / library checker range_chmin_chmax_add_range_sum
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tree.hh"
+
+namespace ext
+{
+
+namespace lz_segtr
+{
+
+template <typename T>
+inline void
+beats_tree<T>::pushup_ (size_t pos)
+{
+    const node_t &l  = node_[pos << 1];
+    const node_t &r  = node_[(pos << 1) + 1];
+    node_t       &nd = node_[pos];
+
+    nd.sum = l.sum + r.sum;
+
+    if (l.max1 == r.max1) {
+        nd.max1 = l.max1;
+        nd.max2 = std::max (l.max2, r.max2);
+        nd.maxc = l.maxc + r.maxc;
+    } else if (l.max1 > r.max1) {
+        nd.max1 = l.max1;
+        nd.max2 = std::max (l.max2, r.max1);
+        nd.maxc = l.maxc;
+    } else {
+        nd.max1 = r.max1;
+        nd.max2 = std::max (l.max1, r.max2);
+        nd.maxc = r.maxc;
+    }
+
+    if (l.min1 == r.min1) {
+        nd.min1 = l.min1;
+        nd.min2 = std::min (l.min2, r.min2);
+        nd.minc = l.minc + r.minc;
+    } else if (l.min1 < r.min1) {
+        nd.min1 = l.min1;
+        nd.min2 = std::min (l.min2, r.min1);
+        nd.minc = l.minc;
+    } else {
+        nd.min1 = r.min1;
+        nd.min2 = std::min (l.min1, r.min2);
+        nd.minc = r.minc;
+    }
+}
+
+template <typename T>
+inline void
+beats_tree<T>::apply_add_ (size_t pos, size_t len, T val)
+{
+    const T LO = std::numeric_limits<T>::lowest ();
+    const T HI = std::numeric_limits<T>::max ();
+
+    node_t &nd = node_[pos];
+
+    // the sentinels of missing second values stay as they are
+    nd.sum += val * (T)len;
+    nd.max1 += val;
+    nd.min1 += val;
+
+    if (nd.max2 != LO)
+        nd.max2 += val;
+
+    if (nd.min2 != HI)
+        nd.min2 += val;
+
+    nd.add += val;
+}
+
+/** Lowers the maximum of a node to val, where max2 < val < max1. */
+template <typename T>
+inline void
+beats_tree<T>::apply_chmin_ (size_t pos, T val)
+{
+    node_t &nd = node_[pos];
+
+    nd.sum -= (nd.max1 - val) * (T)nd.maxc;
+
+    // the maximum may also be the smallest or second smallest value
+    if (nd.min1 == nd.max1)
+        nd.min1 = val;
+    else if (nd.min2 == nd.max1)
+        nd.min2 = val;
+
+    nd.max1 = val;
+}
+
+/** Raises the minimum of a node to val, where min1 < val < min2. */
+template <typename T>
+inline void
+beats_tree<T>::apply_chmax_ (size_t pos, T val)
+{
+    node_t &nd = node_[pos];
+
+    nd.sum += (val - nd.min1) * (T)nd.minc;
+
+    if (nd.max1 == nd.min1)
+        nd.max1 = val;
+    else if (nd.max2 == nd.min1)
+        nd.max2 = val;
+
+    nd.min1 = val;
+}
+
+template <typename T>
+void
+beats_tree<T>::pushdown_ (size_t pos, size_t l, size_t mid, size_t r)
+{
+    size_t lc = pos << 1;
+    size_t rc = lc + 1;
+
+    if (node_[pos].add != 0) {
+        apply_add_ (lc, mid - l + 1, node_[pos].add);
+        apply_add_ (rc, r - mid, node_[pos].add);
+        node_[pos].add = 0;
+    }
+
+    // the children can only be outside of [min1, max1] if a chmin or chmax
+    // stopped at this node
+    for (size_t c = lc; c <= rc; ++c) {
+        if (node_[c].max1 > node_[pos].max1)
+            apply_chmin_ (c, node_[pos].max1);
+
+        if (node_[c].min1 < node_[pos].min1)
+            apply_chmax_ (c, node_[pos].min1);
+    }
+}
+
+template <typename T>
+void
+beats_tree<T>::build_ (size_t pos, size_t lb, size_t rb,
+                       const std::vector<T> &arr)
+{
+    if (lb == rb) {
+        const T LO = std::numeric_limits<T>::lowest ();
+        const T HI = std::numeric_limits<T>::max ();
+
+        node_[pos] = node_t{ arr[lb], arr[lb], LO, 1, arr[lb], HI, 1, 0 };
+        return;
+    }
+
+    size_t mid = lb + ((rb - lb) >> 1);
+
+    build_ (pos << 1, lb, mid, arr);
+    build_ ((pos << 1) + 1, mid + 1, rb, arr);
+
+    pushup_ (pos);
+}
+
+template <typename T>
+beats_tree<T>::beats_tree (const std::vector<T> &arr) : len_ (arr.size ())
+{
+    size_t p2 = len_ <= 1 ? 1 : (size_t)1 << (64 - __builtin_clzll (len_ - 1));
+    node_.resize (p2 << 1);
+
+    if (len_)
+        build_ (1, 0, len_ - 1, arr);
+}
+
+template <typename T>
+void
+beats_tree<T>::chmin_ (size_t start, size_t end, T val, size_t pos_,
+                       size_t l_, size_t r_)
+{
+    // nothing in [lb, rb] is above val
+    if (start > r_ || end < l_ || node_[pos_].max1 <= val)
+        return;
+
+    // only the maximum is above val, so it can be lowered as a tag
+    if (start <= l_ && r_ <= end && node_[pos_].max2 < val) {
+        apply_chmin_ (pos_, val);
+        return;
+    }
+
+    size_t mid = l_ + ((r_ - l_) >> 1);
+    pushdown_ (pos_, l_, mid, r_);
+
+    chmin_ (start, end, val, pos_ << 1, l_, mid);
+    chmin_ (start, end, val, (pos_ << 1) + 1, mid + 1, r_);
+
+    pushup_ (pos_);
+}
+
+template <typename T>
+void
+beats_tree<T>::chmax_ (size_t start, size_t end, T val, size_t pos_,
+                       size_t l_, size_t r_)
+{
+    if (start > r_ || end < l_ || node_[pos_].min1 >= val)
+        return;
+
+    if (start <= l_ && r_ <= end && node_[pos_].min2 > val) {
+        apply_chmax_ (pos_, val);
+        return;
+    }
+
+    size_t mid = l_ + ((r_ - l_) >> 1);
+    pushdown_ (pos_, l_, mid, r_);
+
+    chmax_ (start, end, val, pos_ << 1, l_, mid);
+    chmax_ (start, end, val, (pos_ << 1) + 1, mid + 1, r_);
+
+    pushup_ (pos_);
+}
+
+template <typename T>
+void
+beats_tree<T>::add_ (size_t start, size_t end, T val, size_t pos_, size_t l_,
+                     size_t r_)
+{
+    if (start > r_ || end < l_)
+        return;
+
+    if (start <= l_ && r_ <= end) {
+        apply_add_ (pos_, r_ - l_ + 1, val);
+        return;
+    }
+
+    size_t mid = l_ + ((r_ - l_) >> 1);
+    pushdown_ (pos_, l_, mid, r_);
+
+    add_ (start, end, val, pos_ << 1, l_, mid);
+    add_ (start, end, val, (pos_ << 1) + 1, mid + 1, r_);
+
+    pushup_ (pos_);
+}
+
+/** @return A node holding the sum, min1 and max1 of [start, end]. */
+template <typename T>
+typename beats_tree<T>::node_t
+beats_tree<T>::query_ (size_t start, size_t end, size_t pos_, size_t l_,
+                       size_t r_)
+{
+    if (start <= l_ && r_ <= end)
+        return node_[pos_];
+
+    size_t mid = l_ + ((r_ - l_) >> 1);
+    pushdown_ (pos_, l_, mid, r_);
+
+    if (end <= mid)
+        return query_ (start, end, pos_ << 1, l_, mid);
+
+    if (start > mid)
+        return query_ (start, end, (pos_ << 1) + 1, mid + 1, r_);
+
+    node_t l = query_ (start, end, pos_ << 1, l_, mid);
+    node_t r = query_ (start, end, (pos_ << 1) + 1, mid + 1, r_);
+
+    l.sum += r.sum;
+    l.max1 = std::max (l.max1, r.max1);
+    l.min1 = std::min (l.min1, r.min1);
+
+    return l;
+}
+
+/** Sets every element a[i] in [start, end] to min (a[i], val). */
+template <typename T>
+void
+beats_tree<T>::chmin (size_t start, size_t end, T val)
+{
+    chmin_ (start, end, val, 1, 0, len_ - 1);
+}
+
+/** Sets every element a[i] in [start, end] to max (a[i], val). */
+template <typename T>
+void
+beats_tree<T>::chmax (size_t start, size_t end, T val)
+{
+    chmax_ (start, end, val, 1, 0, len_ - 1);
+}
+
+/** Adds val to every element in [start, end]. */
+template <typename T>
+void
+beats_tree<T>::add (size_t start, size_t end, T val)
+{
+    add_ (start, end, val, 1, 0, len_ - 1);
+}
+
+/** @return The sum of the range [start, end]. */
+template <typename T>
+T
+beats_tree<T>::query_sum (size_t start, size_t end)
+{
+    return query_ (start, end, 1, 0, len_ - 1).sum;
+}
+
+/** @return The minimum of the range [start, end]. */
+template <typename T>
+T
+beats_tree<T>::query_min (size_t start, size_t end)
+{
+    return query_ (start, end, 1, 0, len_ - 1).min1;
+}
+
+/** @return The maximum of the range [start, end]. */
+template <typename T>
+T
+beats_tree<T>::query_max (size_t start, size_t end)
+{
+    return query_ (start, end, 1, 0, len_ - 1).max1;
+}
+
+template class beats_tree<int32_t>;
+template class beats_tree<int64_t>;
+
+} // namespace lz_segtr
+
+} // namespace ext
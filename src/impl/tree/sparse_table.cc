@@ -0,0 +1,149 @@
+// https://cp-algorithms.com/data_structures/sparse-table.html
+// https://cp-algorithms.com/sequences/rmq.html
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "tree.hh"
+
+namespace ext
+{
+
+namespace rmq
+{
+
+template <typename T>
+sparse_table<T>::sparse_table (
+    const std::vector<T> &arr,
+    std::function<T (const T &, const T &)> const &combine)
+    : table_ (arr), len_ (arr.size ()), combine_ (combine)
+{
+    if (len_ == 0)
+        return;
+
+    size_t levels = 64 - __builtin_clzll (len_);
+    table_.resize (levels * len_);
+
+    // each level combines two overlapping ranges of the previous level
+    for (size_t k = 1; k < levels; ++k) {
+        T     *cur  = table_.data () + k * len_;
+        T     *prv  = cur - len_;
+        size_t half = (size_t)1 << (k - 1);
+
+        for (size_t i = 0; i + (half << 1) <= len_; ++i)
+            cur[i] = combine_ (prv[i], prv[i + half]);
+    }
+}
+
+/** @return A query of the non-empty range [start, end). */
+template <typename T>
+T
+sparse_table<T>::query (size_t start, size_t end) const
+{
+    // two ranges of length 2^k cover [start, end). since the operation is
+    // idempotent, it does not matter that they overlap
+    size_t   k   = 63 - __builtin_clzll (end - start);
+    const T *lvl = table_.data () + k * len_;
+
+    return combine_ (lvl[start], lvl[end - ((size_t)1 << k)]);
+}
+
+/** @return The best element of [start, end] within a single block. */
+template <typename T>
+inline T
+block_table<T>::in_block_ (size_t start, size_t end) const
+{
+    size_t   base = start & ~(BLOCK_ - 1);
+    uint64_t m    = mask_[end] & (~0ULL << (start - base));
+
+    return arr_[base + __builtin_ctzll (m)];
+}
+
+/** Fills mask_ and returns the best element of each block. */
+template <typename T>
+std::vector<T>
+block_table<T>::build_ ()
+{
+    const size_t   SZ = arr_.size ();
+    std::vector<T> best;
+    best.reserve ((SZ + BLOCK_ - 1) / BLOCK_);
+
+    for (size_t base = 0; base < SZ; base += BLOCK_) {
+        // monotonic stack of the block, stored as a bitmask of offsets
+        uint64_t stk = 0;
+
+        for (size_t i = base; i < SZ && i < base + BLOCK_; ++i) {
+            while (stk) {
+                size_t top = 63 - __builtin_clzll (stk);
+                if (!cmp_ (arr_[i], arr_[base + top]))
+                    break;
+
+                stk ^= 1ULL << top;
+            }
+
+            stk |= 1ULL << (i - base);
+            mask_[i] = stk;
+        }
+
+        // the bottom of the stack is the best element of the block
+        best.push_back (arr_[base + __builtin_ctzll (stk)]);
+    }
+
+    return best;
+}
+
+template <typename T>
+block_table<T>::block_table (
+    const std::vector<T> &arr,
+    std::function<bool (const T &, const T &)> const &cmp)
+    : arr_ (arr), mask_ (arr.size (), 0), cmp_ (cmp),
+      blocks_ (build_ (), [cmp] (const T &x, const T &y) {
+          return cmp (y, x) ? y : x;
+      })
+{
+}
+
+/** @return A query of the non-empty range [start, end). */
+template <typename T>
+T
+block_table<T>::query (size_t start, size_t end) const
+{
+    --end;
+
+    size_t lb = start / BLOCK_;
+    size_t rb = end / BLOCK_;
+
+    if (lb == rb)
+        return in_block_ (start, end);
+
+    // suffix of the first block, prefix of the last block and everything
+    // in between
+    T ans = in_block_ (start, lb * BLOCK_ + BLOCK_ - 1);
+    T rv  = in_block_ (rb * BLOCK_, end);
+
+    if (cmp_ (rv, ans))
+        ans = rv;
+
+    if (lb + 1 < rb) {
+        T mv = blocks_.query (lb + 1, rb);
+        if (cmp_ (mv, ans))
+            ans = mv;
+    }
+
+    return ans;
+}
+
+template class sparse_table<int32_t>;
+template class sparse_table<int64_t>;
+template class sparse_table<uint32_t>;
+template class sparse_table<uint64_t>;
+
+template class block_table<int32_t>;
+template class block_table<int64_t>;
+template class block_table<uint32_t>;
+template class block_table<uint64_t>;
+
+} // namespace rmq
+
+} // namespace ext
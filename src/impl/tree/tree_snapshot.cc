@@ -0,0 +1,469 @@
+// snapshots of segtr::tree and lz_segtr::tree that can be mapped back into
+// memory without rebuilding the tree
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "tree.hh"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ext
+{
+
+static_assert (sizeof (snapshot_t) == 64, "snapshot header must be 64 bytes");
+
+template <typename T>
+static snapshot_t
+make_header_ (const char *magic, uint32_t op, size_t len, size_t tree_len,
+              size_t lazy_len, const T &dft)
+{
+    snapshot_t hdr;
+    std::memset (&hdr, 0, sizeof (hdr));
+    std::memcpy (hdr.magic, magic, 4);
+
+    hdr.version   = SNAPSHOT_VERSION;
+    hdr.elem_size = sizeof (T);
+    hdr.is_signed = std::numeric_limits<T>::is_signed;
+    hdr.op        = op;
+    hdr.len       = len;
+    hdr.tree_len  = tree_len;
+    hdr.lazy_len  = lazy_len;
+    std::memcpy (&hdr.dft, &dft, sizeof (T));
+
+    return hdr;
+}
+
+/** Writes a header followed by the raw bytes of the tree array, and then
+ * whatever tail writes.
+ * @return If everything was written. */
+static bool
+write_snapshot_ (const char *path, const snapshot_t &hdr, const void *tree,
+                 size_t tree_bytes,
+                 std::function<bool (FILE *)> const &tail = nullptr)
+{
+    FILE *fp = fopen (path, "wb");
+    if (fp == nullptr)
+        return false;
+
+    bool ok = fwrite (&hdr, sizeof (hdr), 1, fp) == 1
+              && fwrite (tree, 1, tree_bytes, fp) == tree_bytes
+              && (!tail || tail (fp));
+
+    return fclose (fp) == 0 && ok;
+}
+
+/** Writes the tags field by field, so that the padding of query_t is written
+ * as zeros instead of whatever was left in memory.
+ * @return If everything was written. */
+template <typename T>
+static bool
+write_tags_ (FILE *fp, const std::vector<lz_segtr::query_t<T> > &lazy)
+{
+    using q_t = lz_segtr::query_t<T>;
+
+    static constexpr size_t CHUNK = 4096;
+    std::vector<char>       buf (CHUNK * sizeof (q_t));
+
+    for (size_t lo = 0; lo < lazy.size (); lo += CHUNK) {
+        size_t cnt = std::min (CHUNK, lazy.size () - lo);
+        std::fill (buf.begin (), buf.end (), 0);
+
+        for (size_t i = 0; i < cnt; ++i) {
+            char *dst = buf.data () + i * sizeof (q_t);
+            std::memcpy (dst + offsetof (q_t, type), &lazy[lo + i].type,
+                         sizeof (lazy[lo + i].type));
+            std::memcpy (dst + offsetof (q_t, val), &lazy[lo + i].val,
+                         sizeof (lazy[lo + i].val));
+        }
+
+        if (fwrite (buf.data (), sizeof (q_t), cnt, fp) != cnt)
+            return false;
+    }
+
+    return true;
+}
+
+/** Maps the whole file at path with a private, writable mapping.
+ * @return The start of the mapping, or nullptr on failure. */
+static void *
+map_file_ (const char *path, size_t *len)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    int fd = ::open (path, O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if (fstat (fd, &st) != 0 || st.st_size < (off_t)sizeof (snapshot_t)) {
+        ::close (fd);
+        return nullptr;
+    }
+
+    *len = st.st_size;
+
+    // MAP_PRIVATE makes writes copy-on-write so that the file is never
+    // modified. the mapping stays valid after the descriptor is closed
+    void *map
+        = mmap (nullptr, *len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close (fd);
+
+    return map == MAP_FAILED ? nullptr : map;
+#else
+    // no mmap: read the file into an aligned buffer instead
+    FILE *fp = fopen (path, "rb");
+    if (fp == nullptr)
+        return nullptr;
+
+    fseek (fp, 0, SEEK_END);
+    long sz = ftell (fp);
+    fseek (fp, 0, SEEK_SET);
+
+    void *buf = sz < (long)sizeof (snapshot_t) ? nullptr : malloc (sz);
+    if (buf != nullptr && fread (buf, 1, sz, fp) != (size_t)sz) {
+        free (buf);
+        buf = nullptr;
+    }
+
+    fclose (fp);
+    *len = sz;
+
+    return buf;
+#endif
+}
+
+static void
+unmap_file_ (void *map, size_t len)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    munmap (map, len);
+#else
+    (void)len;
+    free (map);
+#endif
+}
+
+/** @return If the mapped header describes a snapshot of the given kind with
+ * tree_len and lazy_len elements whose arrays fit inside the mapping. */
+template <typename T>
+static bool
+check_header_ (const snapshot_t *hdr, const char *magic, size_t map_len,
+               uint64_t tree_len, uint64_t lazy_len, size_t lazy_elem)
+{
+    if (std::memcmp (hdr->magic, magic, 4) != 0
+        || hdr->version != SNAPSHOT_VERSION || hdr->elem_size != sizeof (T)
+        || hdr->is_signed != (uint32_t)std::numeric_limits<T>::is_signed
+        || hdr->tree_len != tree_len || hdr->lazy_len != lazy_len)
+        return false;
+
+    // a corrupt header must not wrap the size around to something small
+    uint64_t tree_bytes, lazy_bytes, bytes;
+    if (__builtin_mul_overflow (tree_len, sizeof (T), &tree_bytes)
+        || __builtin_mul_overflow (lazy_len, lazy_elem, &lazy_bytes)
+        || __builtin_add_overflow (tree_bytes, lazy_bytes, &bytes)
+        || __builtin_add_overflow (bytes, sizeof (snapshot_t), &bytes))
+        return false;
+
+    return bytes <= map_len;
+}
+
+namespace segtr
+{
+
+/** Writes a snapshot of the tree to path.
+ * @return If the snapshot was written successfully. */
+template <typename T>
+bool
+tree<T>::save (const char *path) const
+{
+    snapshot_t hdr
+        = make_header_<T> ("SGTR", 0, len_, tree_.size (), 0, DEFAULT_);
+
+    return write_snapshot_ (path, hdr, tree_.data (),
+                            tree_.size () * sizeof (T));
+}
+
+template <typename T>
+mapped_tree<T>::mapped_tree ()
+    : DEFAULT_ (0), map_ (nullptr), map_len_ (0), tree_ (nullptr), len_ (0)
+{
+}
+
+template <typename T> mapped_tree<T>::~mapped_tree () { close_ (); }
+
+template <typename T>
+void
+mapped_tree<T>::close_ ()
+{
+    if (map_ != nullptr)
+        unmap_file_ (map_, map_len_);
+
+    map_  = nullptr;
+    tree_ = nullptr;
+    len_  = 0;
+}
+
+/** Maps the snapshot at path. combine must be the function the tree was built
+ * with.
+ * @return If the file is a valid snapshot of a tree<T>. */
+template <typename T>
+bool
+mapped_tree<T>::open (const char                                    *path,
+                      std::function<T (const T &, const T &)> const &combine)
+{
+    close_ ();
+
+    map_ = map_file_ (path, &map_len_);
+    if (map_ == nullptr)
+        return false;
+
+    // the leaves start at tree_[len], so the tree must hold exactly 2 len
+    const snapshot_t *hdr = (const snapshot_t *)map_;
+    if (hdr->len > SIZE_MAX / 2
+        || !check_header_<T> (hdr, "SGTR", map_len_, hdr->len << 1, 0, 0)) {
+        close_ ();
+        return false;
+    }
+
+    std::memcpy (&DEFAULT_, &hdr->dft, sizeof (T));
+    tree_    = (T *)((char *)map_ + sizeof (snapshot_t));
+    len_     = hdr->len;
+    combine_ = combine;
+
+    return true;
+}
+
+/** Sets the value at id to val */
+template <typename T>
+void
+mapped_tree<T>::set (size_t idx, T val)
+{
+    idx += len_;
+    tree_[idx] = val;
+
+    for (; idx > 1; idx >>= 1)
+        tree_[idx >> 1] = combine_ (tree_[idx], tree_[idx ^ 1]);
+}
+
+/** @return A query of the range [start, end) */
+template <typename T>
+T
+mapped_tree<T>::query (size_t start, size_t end) const
+{
+    T ans = DEFAULT_;
+    for (start += len_, end += len_; start < end; start >>= 1, end >>= 1) {
+        if (start & 1)
+            ans = combine_ (ans, tree_[start++]);
+
+        if (end & 1)
+            ans = combine_ (ans, tree_[--end]);
+    }
+
+    return ans;
+}
+
+/** @return The length of the array. */
+template <typename T>
+size_t
+mapped_tree<T>::size () const
+{
+    return len_;
+}
+
+template bool tree<int32_t>::save (const char *path) const;
+template bool tree<int64_t>::save (const char *path) const;
+template bool tree<uint32_t>::save (const char *path) const;
+template bool tree<uint64_t>::save (const char *path) const;
+
+template class mapped_tree<int32_t>;
+template class mapped_tree<int64_t>;
+template class mapped_tree<uint32_t>;
+template class mapped_tree<uint64_t>;
+
+} // namespace segtr
+
+namespace lz_segtr
+{
+
+/** Writes a snapshot of the tree, including pending tags, to path.
+ * @return If the snapshot was written successfully. */
+template <typename T>
+bool
+tree<T>::save (const char *path) const
+{
+    snapshot_t hdr = make_header_<T> ("LZST", type_, len_, tree_.size (),
+                                      lazy_.size (), DEFAULT_);
+
+    return write_snapshot_ (path, hdr, tree_.data (),
+                            tree_.size () * sizeof (T), [this] (FILE *fp) {
+                                return write_tags_ (fp, lazy_);
+                            });
+}
+
+template <typename T>
+mapped_tree<T>::mapped_tree ()
+    : DEFAULT_ (0), map_ (nullptr), map_len_ (0), tree_ (nullptr),
+      lazy_ (nullptr), len_ (0), type_ (SUM)
+{
+}
+
+template <typename T> mapped_tree<T>::~mapped_tree () { close_ (); }
+
+template <typename T>
+void
+mapped_tree<T>::close_ ()
+{
+    if (map_ != nullptr)
+        unmap_file_ (map_, map_len_);
+
+    map_  = nullptr;
+    tree_ = nullptr;
+    lazy_ = nullptr;
+    len_  = 0;
+}
+
+template <typename T>
+inline T
+mapped_tree<T>::combine_ (const T &x, const T &y) const
+{
+    switch (type_) {
+        case MIN:
+            return std::min (x, y);
+        case MAX:
+            return std::max (x, y);
+        default:
+            return x + y;
+    }
+}
+
+/** @return The value of a node of len elements after applying q. */
+template <typename T>
+inline T
+mapped_tree<T>::apply_ (const query_t<T> &q, const T &val, size_t len) const
+{
+    // same as tree::upd_upstream_
+    T upstream = type_ == SUM ? q.val * (T)len : q.val;
+
+    switch (q.type) {
+        case ADD:
+            return val + upstream;
+        case SET:
+            return upstream;
+        default:
+            return val;
+    }
+}
+
+/** @return The tag equivalent to applying older and then newer. */
+template <typename T>
+inline query_t<T>
+mapped_tree<T>::compose_ (const query_t<T> &newer,
+                          const query_t<T> &older) const
+{
+    // same as the tag update in tree::apply_
+    if (newer.type == NONE)
+        return older;
+
+    if (newer.type == SET || older.type == NONE)
+        return newer;
+
+    return query_t<T>{ older.type, older.val + newer.val };
+}
+
+template <typename T>
+T
+mapped_tree<T>::query_ (size_t start, size_t end, const query_t<T> &tag,
+                        size_t pos_, size_t l_, size_t r_) const
+{
+    if (start > r_ || end < l_)
+        return DEFAULT_;
+
+    // tree_[pos] already includes its own tag, but not the ones above it
+    if (start <= l_ && end >= r_)
+        return apply_ (tag, tree_[pos_], r_ - l_ + 1);
+
+    // the tag of this node is older than the ones above it
+    query_t<T> down = compose_ (tag, lazy_[pos_]);
+
+    size_t mid = l_ + ((r_ - l_) >> 1);
+    size_t lc  = pos_ << 1;
+
+    return combine_ (query_ (start, end, down, lc, l_, mid),
+                     query_ (start, end, down, lc + 1, mid + 1, r_));
+}
+
+/** Maps the snapshot at path.
+ * @return If the file is a valid snapshot of a tree<T>. */
+template <typename T>
+bool
+mapped_tree<T>::open (const char *path)
+{
+    close_ ();
+
+    map_ = map_file_ (path, &map_len_);
+    if (map_ == nullptr)
+        return false;
+
+    // both arrays are as long as in tree::tree, and query needs len > 0
+    const snapshot_t *hdr = (const snapshot_t *)map_;
+    uint64_t          n   = hdr->len == 0 || hdr->len > SIZE_MAX / 4
+                                ? 0
+                                : utl::next_p2 (hdr->len) << 1;
+    if (n == 0
+        || !check_header_<T> (hdr, "LZST", map_len_, n, n,
+                              sizeof (query_t<T>))
+        || hdr->op > MAX) {
+        close_ ();
+        return false;
+    }
+
+    std::memcpy (&DEFAULT_, &hdr->dft, sizeof (T));
+    tree_ = (const T *)((const char *)map_ + sizeof (snapshot_t));
+    lazy_ = (const query_t<T> *)(tree_ + hdr->tree_len);
+    len_  = hdr->len;
+    type_ = (treeop_e)hdr->op;
+
+    return true;
+}
+
+/** @return A query of the range [start, end]. */
+template <typename T>
+T
+mapped_tree<T>::query (size_t start, size_t end) const
+{
+    return query_ (start, end, query_t<T> (), 1, 0, len_ - 1);
+}
+
+/** @return The length of the array. */
+template <typename T>
+size_t
+mapped_tree<T>::size () const
+{
+    return len_;
+}
+
+template bool tree<int32_t>::save (const char *path) const;
+template bool tree<int64_t>::save (const char *path) const;
+template bool tree<uint32_t>::save (const char *path) const;
+template bool tree<uint64_t>::save (const char *path) const;
+
+template class mapped_tree<int32_t>;
+template class mapped_tree<int64_t>;
+template class mapped_tree<uint32_t>;
+template class mapped_tree<uint64_t>;
+
+} // namespace lz_segtr
+
+} // namespace ext
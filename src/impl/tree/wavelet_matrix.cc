@@ -0,0 +1,399 @@
+// https://miti-7.hatenablog.com/entry/2018/04/28/152259
+// https://users.dcc.uchile.cl/~gnavarro/ps/spire12.4.pdf
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "tree.hh"
+
+namespace ext
+{
+
+namespace wvlt
+{
+
+/** @return The position of the k-th set bit (0-indexed) of x, which must
+ * have more than k set bits. */
+static inline size_t
+select_in_word_ (uint64_t x, size_t k)
+{
+#if defined(__BMI2__)
+    return __builtin_ctzll (_pdep_u64 ((uint64_t)1 << k, x));
+#else
+    // narrow down to the byte that holds the bit, then clear the lower ones
+    size_t pos = 0;
+    for (size_t cnt; (cnt = __builtin_popcountll (x & 0xff)) <= k;) {
+        k -= cnt;
+        x >>= 8;
+        pos += 8;
+    }
+
+    for (; k > 0; --k)
+        x &= x - 1;
+
+    return pos + __builtin_ctzll (x);
+#endif
+}
+
+bit_vector::bit_vector (size_t len)
+    : words_ ((len + 63) / 64 + 1, 0), len_ (len)
+{
+}
+
+/** Sets the bit at idx. Must be called before build. */
+void
+bit_vector::set (size_t idx)
+{
+    words_[idx >> 6] |= (uint64_t)1 << (idx & 63);
+}
+
+/** Fills the rank directory. */
+void
+bit_vector::build ()
+{
+    constexpr size_t WPB = BLOCK_ / 64; // words per block
+
+    size_t blocks = len_ / BLOCK_ + 1;
+    rank_.assign (blocks + 1, 0);
+
+    for (size_t b = 0; b < blocks; ++b) {
+        size_t cnt = 0;
+        for (size_t w = b * WPB; w < (b + 1) * WPB && w < words_.size (); ++w)
+            cnt += __builtin_popcountll (words_[w]);
+
+        rank_[b + 1] = rank_[b] + cnt;
+    }
+}
+
+/** @return The bit at idx. */
+bool
+bit_vector::get (size_t idx) const
+{
+    return (words_[idx >> 6] >> (idx & 63)) & 1;
+}
+
+/** @return The number of ones in the range [0, end). */
+size_t
+bit_vector::rank1 (size_t end) const
+{
+    size_t ans = rank_[end / BLOCK_];
+    for (size_t w = end / BLOCK_ * (BLOCK_ / 64); w < (end >> 6); ++w)
+        ans += __builtin_popcountll (words_[w]);
+
+    if (end & 63)
+        ans += __builtin_popcountll (words_[end >> 6]
+                                     & (((uint64_t)1 << (end & 63)) - 1));
+
+    return ans;
+}
+
+/** @return The number of zeros in the range [0, end). */
+size_t
+bit_vector::rank0 (size_t end) const
+{
+    return end - rank1 (end);
+}
+
+/** @return The position of the k-th one (0-indexed), or len if there is
+ * none. */
+size_t
+bit_vector::select1 (size_t k) const
+{
+    if (k >= rank1 (len_))
+        return len_;
+
+    // the last block with fewer than k + 1 ones before it
+    size_t b = std::upper_bound (rank_.begin (), rank_.end (), k)
+               - rank_.begin () - 1;
+
+    k -= rank_[b];
+
+    size_t w = b * (BLOCK_ / 64);
+    for (size_t cnt; (cnt = __builtin_popcountll (words_[w])) <= k; ++w)
+        k -= cnt;
+
+    return (w << 6) + select_in_word_ (words_[w], k);
+}
+
+/** @return The position of the k-th zero (0-indexed), or len if there is
+ * none. */
+size_t
+bit_vector::select0 (size_t k) const
+{
+    if (k >= rank0 (len_))
+        return len_;
+
+    // same as select1, but with the number of zeros before each block
+    size_t lo = 0, hi = rank_.size () - 1;
+    while (hi - lo > 1) {
+        size_t mid = lo + ((hi - lo) >> 1);
+        if (mid * BLOCK_ - rank_[mid] <= k)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    k -= lo * BLOCK_ - rank_[lo];
+
+    size_t w = lo * (BLOCK_ / 64);
+    for (size_t cnt; (cnt = __builtin_popcountll (~words_[w])) <= k; ++w)
+        k -= cnt;
+
+    return (w << 6) + select_in_word_ (~words_[w], k);
+}
+
+/** @return The number of bits. */
+size_t
+bit_vector::size () const
+{
+    return len_;
+}
+
+template <typename T>
+inline uint64_t
+matrix<T>::key_ (T val)
+{
+    using U = std::make_unsigned_t<T>;
+
+    if constexpr (std::is_signed_v<T>)
+        return (U)val ^ ((U)1 << (sizeof (T) * 8 - 1));
+    else
+        return val;
+}
+
+template <typename T>
+inline T
+matrix<T>::val_ (uint64_t key)
+{
+    using U = std::make_unsigned_t<T>;
+
+    if constexpr (std::is_signed_v<T>)
+        return (T)((U)key ^ ((U)1 << (sizeof (T) * 8 - 1)));
+    else
+        return (T)key;
+}
+
+template <typename T>
+matrix<T>::matrix (const std::vector<T> &arr)
+    : len_ (arr.size ()), log_ (0), base_ (UINT64_MAX)
+{
+    std::vector<uint64_t> cur (len_), nxt (len_);
+
+    uint64_t max_key = 0;
+    for (size_t i = 0; i < len_; ++i) {
+        cur[i]  = key_ (arr[i]);
+        base_   = std::min (base_, cur[i]);
+        max_key = std::max (max_key, cur[i]);
+    }
+
+    // the flipped sign bit would otherwise make every signed array take all
+    // the levels, so only the spread of the keys is stored
+    base_ = len_ ? base_ : 0;
+    for (size_t i = 0; i < len_; ++i)
+        cur[i] -= base_;
+
+    max_key -= base_;
+    log_ = max_key ? 64 - __builtin_clzll (max_key) : 1;
+
+    level_.assign (log_, bit_vector (len_));
+    zeros_.assign (log_, 0);
+
+    for (size_t l = 0; l < log_; ++l) {
+        size_t bit = log_ - 1 - l;
+
+        for (size_t i = 0; i < len_; ++i)
+            if ((cur[i] >> bit) & 1)
+                level_[l].set (i);
+            else
+                ++zeros_[l];
+
+        level_[l].build ();
+
+        // stable partition by the bit
+        size_t z = 0, o = zeros_[l];
+        for (size_t i = 0; i < len_; ++i)
+            nxt[((cur[i] >> bit) & 1) ? o++ : z++] = cur[i];
+
+        cur.swap (nxt);
+    }
+}
+
+/** @return The element at idx. */
+template <typename T>
+T
+matrix<T>::access (size_t idx) const
+{
+    uint64_t key = 0;
+    for (size_t l = 0; l < log_; ++l) {
+        const bit_vector &bv = level_[l];
+
+        if (bv.get (idx)) {
+            key |= (uint64_t)1 << (log_ - 1 - l);
+            idx = zeros_[l] + bv.rank1 (idx);
+        } else {
+            idx = bv.rank0 (idx);
+        }
+    }
+
+    return val_ (key + base_);
+}
+
+/** @return The number of occurrences of val in the range [0, end). */
+template <typename T>
+size_t
+matrix<T>::rank (T val, size_t end) const
+{
+    uint64_t key = key_ (val);
+    if (key < base_)
+        return 0;
+
+    key -= base_;
+    if (log_ < 64 && (key >> log_))
+        return 0;
+
+    // [start, end) is the range of the elements that share the bits of key
+    // seen so far
+    size_t start = 0;
+    for (size_t l = 0; l < log_; ++l) {
+        const bit_vector &bv = level_[l];
+
+        if ((key >> (log_ - 1 - l)) & 1) {
+            start = zeros_[l] + bv.rank1 (start);
+            end   = zeros_[l] + bv.rank1 (end);
+        } else {
+            start = bv.rank0 (start);
+            end   = bv.rank0 (end);
+        }
+    }
+
+    return end - start;
+}
+
+/** @return The position of the k-th occurrence (0-indexed) of val, or len if
+ * there is none. */
+template <typename T>
+size_t
+matrix<T>::select (T val, size_t k) const
+{
+    if (rank (val, len_) <= k)
+        return len_;
+
+    // find where the occurrences of val start on the last level
+    uint64_t key   = key_ (val) - base_;
+    size_t   start = 0;
+
+    for (size_t l = 0; l < log_; ++l) {
+        if ((key >> (log_ - 1 - l)) & 1)
+            start = zeros_[l] + level_[l].rank1 (start);
+        else
+            start = level_[l].rank0 (start);
+    }
+
+    // and walk the k-th of them back up
+    size_t pos = start + k;
+    for (size_t l = log_; l-- > 0;) {
+        if ((key >> (log_ - 1 - l)) & 1)
+            pos = level_[l].select1 (pos - zeros_[l]);
+        else
+            pos = level_[l].select0 (pos);
+    }
+
+    return pos;
+}
+
+/** @return The k-th smallest element (0-indexed) in the range [start, end).
+ * k must be less than end - start. */
+template <typename T>
+T
+matrix<T>::kth_smallest (size_t start, size_t end, size_t k) const
+{
+    uint64_t key = 0;
+    for (size_t l = 0; l < log_; ++l) {
+        const bit_vector &bv = level_[l];
+
+        size_t zs = bv.rank0 (start);
+        size_t ze = bv.rank0 (end);
+
+        if (k < ze - zs) {
+            start = zs;
+            end   = ze;
+        } else {
+            k -= ze - zs;
+            key |= (uint64_t)1 << (log_ - 1 - l);
+            start = zeros_[l] + (start - zs);
+            end   = zeros_[l] + (end - ze);
+        }
+    }
+
+    return val_ (key + base_);
+}
+
+template <typename T>
+size_t
+matrix<T>::count_less_ (size_t start, size_t end, uint64_t key) const
+{
+    if (log_ < 64 && (key >> log_))
+        return end - start;
+
+    size_t ans = 0;
+    for (size_t l = 0; l < log_ && start < end; ++l) {
+        const bit_vector &bv = level_[l];
+
+        size_t zs = bv.rank0 (start);
+        size_t ze = bv.rank0 (end);
+
+        // every element with a 0 here is smaller when key has a 1
+        if ((key >> (log_ - 1 - l)) & 1) {
+            ans += ze - zs;
+            start = zeros_[l] + (start - zs);
+            end   = zeros_[l] + (end - ze);
+        } else {
+            start = zs;
+            end   = ze;
+        }
+    }
+
+    return ans;
+}
+
+/** @return The number of elements in the range [start, end) whose value is in
+ * [lo, hi). */
+template <typename T>
+size_t
+matrix<T>::range_freq (size_t start, size_t end, T lo, T hi) const
+{
+    if (!(lo < hi))
+        return 0;
+
+    // nothing is below the smallest key
+    auto less = [&] (T val) -> size_t {
+        uint64_t key = key_ (val);
+        return key <= base_ ? 0 : count_less_ (start, end, key - base_);
+    };
+
+    return less (hi) - less (lo);
+}
+
+/** @return The length of the array. */
+template <typename T>
+size_t
+matrix<T>::size () const
+{
+    return len_;
+}
+
+template class matrix<int32_t>;
+template class matrix<int64_t>;
+template class matrix<uint32_t>;
+template class matrix<uint64_t>;
+
+} // namespace wvlt
+
+} // namespace ext
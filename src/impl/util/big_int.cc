@@ -0,0 +1,696 @@
+// https://gmplib.org/manual/Multiplication-Algorithms
+// https://en.wikipedia.org/wiki/Toom-Cook_multiplication
+// Knuth, TAOCP vol. 2, 4.3.1, Algorithm D
+// https://cacr.uwaterloo.ca/hac/about/chap14.pdf, 14.6.1
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "util.hh"
+
+namespace ext
+{
+
+namespace utl
+{
+
+__extension__ typedef unsigned __int128 uwide_t;
+
+typedef std::vector<uint64_t> limbs_t;
+
+// operand sizes, in limbs, from which Karatsuba and Toom-3 take over
+static constexpr size_t KARATSUBA_ = 48;
+static constexpr size_t TOOM3_     = 160;
+
+// the largest power of ten in a limb, and its number of digits
+static constexpr uint64_t DEC_BASE_   = 10000000000000000000ULL;
+static constexpr size_t   DEC_DIGITS_ = 19;
+
+static void
+trim_ (limbs_t &a)
+{
+    while (!a.empty () && a.back () == 0)
+        a.pop_back ();
+}
+
+static int
+cmp_ (const limbs_t &a, const limbs_t &b)
+{
+    if (a.size () != b.size ())
+        return a.size () < b.size () ? -1 : 1;
+
+    for (size_t i = a.size (); i-- > 0;)
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+
+    return 0;
+}
+
+/** Adds the bn limbs of b, shifted up by shift limbs, to a. */
+static void
+add_at_ (limbs_t &a, const uint64_t *b, size_t bn, size_t shift)
+{
+    if (a.size () < shift + bn)
+        a.resize (shift + bn, 0);
+
+    uint64_t carry = 0;
+    size_t   i     = shift;
+    for (size_t j = 0; j < bn; ++i, ++j) {
+        uint64_t s = a[i] + carry;
+        carry      = s < carry;
+        s += b[j];
+        carry += s < b[j];
+        a[i] = s;
+    }
+
+    for (; carry; ++i) {
+        if (i == a.size ())
+            a.push_back (0);
+
+        carry = ++a[i] == 0;
+    }
+}
+
+static void
+add_at_ (limbs_t &a, const limbs_t &b, size_t shift)
+{
+    add_at_ (a, b.data (), b.size (), shift);
+}
+
+/** Subtracts b from a, which must be at least b. */
+static void
+sub_in_ (limbs_t &a, const limbs_t &b)
+{
+    uint64_t borrow = 0;
+    size_t   i      = 0;
+    for (; i < b.size (); ++i) {
+        uint64_t y = b[i] + borrow;
+        borrow     = (y < borrow) | (a[i] < y);
+        a[i] -= y;
+    }
+
+    for (; borrow; ++i)
+        borrow = a[i]-- == 0;
+
+    trim_ (a);
+}
+
+/** Multiplies a by mul and adds add, in place. */
+static void
+mul_add_small_ (limbs_t &a, uint64_t mul, uint64_t add)
+{
+    uint64_t carry = add;
+    for (uint64_t &x : a) {
+        uwide_t t = (uwide_t)x * mul + carry;
+        x         = (uint64_t)t;
+        carry     = t >> 64;
+    }
+
+    if (carry)
+        a.push_back (carry);
+}
+
+/** Divides a by div in place.
+ * @return The remainder. */
+static uint64_t
+div_small_ (limbs_t &a, uint64_t div)
+{
+    uwide_t rem = 0;
+    for (size_t i = a.size (); i-- > 0;) {
+        uwide_t cur = (rem << 64) | a[i];
+        a[i]        = cur / div;
+        rem         = cur % div;
+    }
+
+    trim_ (a);
+    return rem;
+}
+
+static void
+shl1_ (limbs_t &a)
+{
+    uint64_t carry = 0;
+    for (uint64_t &x : a) {
+        uint64_t top = x >> 63;
+        x            = (x << 1) | carry;
+        carry        = top;
+    }
+
+    if (carry)
+        a.push_back (carry);
+}
+
+static void
+shr1_ (limbs_t &a)
+{
+    for (size_t i = 0; i < a.size (); ++i)
+        a[i] = (a[i] >> 1) | (i + 1 < a.size () ? a[i + 1] << 63 : 0);
+
+    trim_ (a);
+}
+
+/** Writes the an + bn limbs of a times b to c. */
+static void
+mul_school_ (const uint64_t *a, size_t an, const uint64_t *b, size_t bn,
+             uint64_t *c)
+{
+    std::fill (c, c + an + bn, 0);
+
+    for (size_t i = 0; i < an; ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < bn; ++j) {
+            uwide_t t = (uwide_t)a[i] * b[j] + c[i + j] + carry;
+            c[i + j]  = (uint64_t)t;
+            carry     = t >> 64;
+        }
+
+        c[i + bn] = carry;
+    }
+}
+
+static limbs_t mul_ (const limbs_t &a, const limbs_t &b);
+
+/** @return The limbs [lo, lo + len) of a, or the ones of them it has. */
+static limbs_t
+slice_ (const limbs_t &a, size_t lo, size_t len)
+{
+    lo      = std::min (lo, a.size ());
+    limbs_t s (a.begin () + lo, a.begin () + std::min (lo + len, a.size ()));
+    trim_ (s);
+
+    return s;
+}
+
+static limbs_t
+karatsuba_ (const limbs_t &a, const limbs_t &b)
+{
+    size_t m = std::max (a.size (), b.size ()) / 2;
+
+    limbs_t a0 = slice_ (a, 0, m), a1 = slice_ (a, m, a.size ());
+    limbs_t b0 = slice_ (b, 0, m), b1 = slice_ (b, m, b.size ());
+
+    limbs_t z0 = mul_ (a0, b0), z2 = mul_ (a1, b1);
+
+    // (a0 + a1) (b0 + b1) - z0 - z2 = a0 b1 + a1 b0
+    add_at_ (a0, a1, 0);
+    add_at_ (b0, b1, 0);
+    limbs_t z1 = mul_ (a0, b0);
+    sub_in_ (z1, z0);
+    sub_in_ (z1, z2);
+
+    limbs_t c = z0;
+    add_at_ (c, z1, m);
+    add_at_ (c, z2, 2 * m);
+    trim_ (c);
+
+    return c;
+}
+
+// a magnitude with a sign, for the negative points of Toom-3
+struct signed_t {
+    limbs_t mag;
+    bool    neg;
+};
+
+static signed_t
+add_ (const signed_t &a, const signed_t &b)
+{
+    if (a.neg == b.neg) {
+        signed_t c = a;
+        add_at_ (c.mag, b.mag, 0);
+        return c;
+    }
+
+    // the smaller magnitude is taken from the larger one
+    int      cmp = cmp_ (a.mag, b.mag);
+    signed_t c   = cmp >= 0 ? a : b;
+    sub_in_ (c.mag, cmp >= 0 ? b.mag : a.mag);
+    c.neg = c.neg && !c.mag.empty ();
+
+    return c;
+}
+
+static signed_t
+sub_ (const signed_t &a, const signed_t &b)
+{
+    return add_ (a, { b.mag, !b.neg && !b.mag.empty () });
+}
+
+static limbs_t
+toom3_ (const limbs_t &a, const limbs_t &b)
+{
+    size_t k = (std::max (a.size (), b.size ()) + 2) / 3;
+
+    // both are evaluated at 0, 1, -1, -2 and infinity
+    auto eval = [&] (const limbs_t &x, signed_t *v) {
+        signed_t x0 = { slice_ (x, 0, k), false };
+        signed_t x1 = { slice_ (x, k, k), false };
+        signed_t x2 = { slice_ (x, 2 * k, k), false };
+
+        signed_t p = add_ (x0, x2);
+        v[0]       = x0;
+        v[1]       = add_ (p, x1);
+        v[2]       = sub_ (p, x1);
+        v[3]       = add_ (v[2], x2);
+        shl1_ (v[3].mag);
+        v[3] = sub_ (v[3], x0);
+        v[4] = x2;
+    };
+
+    signed_t va[5], vb[5], r[5];
+    eval (a, va);
+    eval (b, vb);
+
+    for (size_t i = 0; i < 5; ++i) {
+        r[i].mag = mul_ (va[i].mag, vb[i].mag);
+        r[i].neg = va[i].neg != vb[i].neg && !r[i].mag.empty ();
+    }
+
+    // Bodrato's interpolation sequence. the divisions are exact
+    signed_t r3 = sub_ (r[3], r[1]);
+    div_small_ (r3.mag, 3);
+
+    signed_t r1 = sub_ (r[1], r[2]);
+    shr1_ (r1.mag);
+
+    signed_t r2 = sub_ (r[2], r[0]);
+
+    r3 = sub_ (r2, r3);
+    shr1_ (r3.mag);
+    signed_t inf2 = r[4];
+    shl1_ (inf2.mag);
+    r3 = add_ (r3, inf2);
+
+    r2 = sub_ (add_ (r2, r1), r[4]);
+    r1 = sub_ (r1, r3);
+
+    // the coefficients of a product of non-negative polynomials are
+    // non-negative
+    limbs_t c = r[0].mag;
+    add_at_ (c, r1.mag, k);
+    add_at_ (c, r2.mag, 2 * k);
+    add_at_ (c, r3.mag, 3 * k);
+    add_at_ (c, r[4].mag, 4 * k);
+    trim_ (c);
+
+    return c;
+}
+
+/** @return The magnitude of a times b, with the product that suits their
+ * sizes. */
+static limbs_t
+mul_ (const limbs_t &a, const limbs_t &b)
+{
+    if (a.size () < b.size ())
+        return mul_ (b, a);
+
+    const size_t an = a.size (), bn = b.size ();
+    if (bn == 0)
+        return {};
+
+    if (bn < KARATSUBA_) {
+        limbs_t c (an + bn);
+        mul_school_ (a.data (), an, b.data (), bn, c.data ());
+        trim_ (c);
+        return c;
+    }
+
+    // splitting in halves or thirds only pays off on balanced operands, so
+    // a long a is multiplied in pieces as long as b
+    if (an >= 2 * bn) {
+        limbs_t c;
+        for (size_t lo = 0; lo < an; lo += bn)
+            add_at_ (c, mul_ (slice_ (a, lo, bn), b), lo);
+
+        trim_ (c);
+        return c;
+    }
+
+    return bn < TOOM3_ ? karatsuba_ (a, b) : toom3_ (a, b);
+}
+
+/** Sets q and r to the quotient and remainder of the magnitudes a and b,
+ * where b is not zero. */
+static void
+divmod_ (const limbs_t &a, const limbs_t &b, limbs_t &q, limbs_t &r)
+{
+    if (cmp_ (a, b) < 0) {
+        q.clear ();
+        r = a;
+        return;
+    }
+
+    if (b.size () == 1) {
+        q = a;
+        r = { div_small_ (q, b[0]) };
+        trim_ (r);
+        return;
+    }
+
+    // shift both so that the top bit of b is set, which keeps every guess of
+    // a quotient limb at most 2 too large
+    const size_t n = b.size (), m = a.size () - n;
+    const int    s = __builtin_clzll (b.back ());
+
+    limbs_t v (n), u (a.size () + 1);
+    for (size_t i = n; i-- > 0;)
+        v[i] = (b[i] << s) | (s && i ? b[i - 1] >> (64 - s) : 0);
+
+    u[a.size ()] = s ? a.back () >> (64 - s) : 0;
+    for (size_t i = a.size (); i-- > 0;)
+        u[i] = (a[i] << s) | (s && i ? a[i - 1] >> (64 - s) : 0);
+
+    q.assign (m + 1, 0);
+    for (size_t j = m + 1; j-- > 0;) {
+        uwide_t num  = ((uwide_t)u[j + n] << 64) | u[j + n - 1];
+        uwide_t qhat = num / v[n - 1], rhat = num % v[n - 1];
+
+        while ((qhat >> 64)
+               || qhat * v[n - 2] > ((rhat << 64) | u[j + n - 2])) {
+            --qhat;
+            rhat += v[n - 1];
+            if (rhat >> 64)
+                break;
+        }
+
+        // u -= qhat * v, shifted up by j limbs
+        uint64_t carry = 0, borrow = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uwide_t  p  = qhat * v[i] + carry;
+            uint64_t pl = (uint64_t)p;
+            carry       = p >> 64;
+
+            uint64_t x = u[i + j];
+            u[i + j]   = x - pl - borrow;
+            borrow     = (x < pl) | (x - pl < borrow);
+        }
+
+        uint64_t x = u[j + n];
+        u[j + n]   = x - carry - borrow;
+
+        // the guess was still one too large, so v is added back
+        if ((x < carry) | (x - carry < borrow)) {
+            --qhat;
+
+            carry = 0;
+            for (size_t i = 0; i < n; ++i) {
+                uwide_t t = (uwide_t)u[i + j] + v[i] + carry;
+                u[i + j]  = (uint64_t)t;
+                carry     = t >> 64;
+            }
+
+            u[j + n] += carry;
+        }
+
+        q[j] = (uint64_t)qhat;
+    }
+
+    r.resize (n);
+    for (size_t i = 0; i < n; ++i)
+        r[i] = (u[i] >> s) | (s ? u[i + 1] << (64 - s) : 0);
+
+    trim_ (q);
+    trim_ (r);
+}
+
+big_int::big_int (std::vector<uint64_t> mag, bool neg)
+    : mag_ (std::move (mag)), neg_ (neg)
+{
+    trim_ (mag_);
+    neg_ = neg_ && !mag_.empty ();
+}
+
+big_int::big_int (int64_t val) : neg_ (val < 0)
+{
+    if (val)
+        mag_ = { val < 0 ? -(uint64_t)val : (uint64_t)val };
+}
+
+big_int::big_int (const std::string &str) : neg_ (false)
+{
+    size_t i = 0;
+    bool   neg = false;
+    if (i < str.size () && (str[i] == '-' || str[i] == '+'))
+        neg = str[i++] == '-';
+
+    // the digits are read a limb's worth at a time
+    while (i < str.size ()) {
+        size_t   len = std::min (DEC_DIGITS_, str.size () - i);
+        uint64_t pw = 1, chunk = 0;
+        for (size_t j = 0; j < len; ++j, ++i) {
+            chunk = chunk * 10 + (str[i] - '0');
+            pw *= 10;
+        }
+
+        mul_add_small_ (mag_, pw, chunk);
+        trim_ (mag_);
+    }
+
+    neg_ = neg && !mag_.empty ();
+}
+
+big_int
+big_int::operator+ (const big_int &other) const
+{
+    signed_t c = add_ ({ mag_, neg_ }, { other.mag_, other.neg_ });
+    return big_int (std::move (c.mag), c.neg);
+}
+
+big_int
+big_int::operator- (const big_int &other) const
+{
+    signed_t c = sub_ ({ mag_, neg_ }, { other.mag_, other.neg_ });
+    return big_int (std::move (c.mag), c.neg);
+}
+
+big_int
+big_int::operator* (const big_int &other) const
+{
+    return big_int (mul_ (mag_, other.mag_), neg_ != other.neg_);
+}
+
+big_int
+big_int::operator/ (const big_int &other) const
+{
+    big_int quot, rem;
+    divmod (other, quot, rem);
+
+    return quot;
+}
+
+big_int
+big_int::operator% (const big_int &other) const
+{
+    big_int quot, rem;
+    divmod (other, quot, rem);
+
+    return rem;
+}
+
+big_int
+big_int::operator- () const
+{
+    return big_int (mag_, !neg_);
+}
+
+big_int &
+big_int::operator+= (const big_int &other)
+{
+    return *this = *this + other;
+}
+
+big_int &
+big_int::operator-= (const big_int &other)
+{
+    return *this = *this - other;
+}
+
+big_int &
+big_int::operator*= (const big_int &other)
+{
+    return *this = *this * other;
+}
+
+big_int &
+big_int::operator/= (const big_int &other)
+{
+    return *this = *this / other;
+}
+
+big_int &
+big_int::operator%= (const big_int &other)
+{
+    return *this = *this % other;
+}
+
+bool
+big_int::operator< (const big_int &other) const
+{
+    if (neg_ != other.neg_)
+        return neg_;
+
+    int cmp = cmp_ (mag_, other.mag_);
+    return neg_ ? cmp > 0 : cmp < 0;
+}
+
+bool
+big_int::operator> (const big_int &other) const
+{
+    return other < *this;
+}
+
+bool
+big_int::operator== (const big_int &other) const
+{
+    return neg_ == other.neg_ && mag_ == other.mag_;
+}
+
+bool
+big_int::operator!= (const big_int &other) const
+{
+    return !(*this == other);
+}
+
+void
+big_int::divmod (const big_int &other, big_int &quot, big_int &rem) const
+{
+    limbs_t q, r;
+    divmod_ (mag_, other.mag_, q, r);
+
+    // the quotient is truncated, so the remainder keeps the sign of this
+    quot = big_int (std::move (q), neg_ != other.neg_);
+    rem  = big_int (std::move (r), neg_);
+}
+
+big_int
+big_int::pow_mod (const big_int &exp, const big_int &mod) const
+{
+    const size_t bits = exp.bits ();
+
+    auto bit = [&] (size_t i) { return (exp.mag_[i / 64] >> (i % 64)) & 1; };
+
+    auto mulmod = [&] (const limbs_t &a, const limbs_t &b) {
+        limbs_t q, r;
+        divmod_ (mul_ (a, b), mod.mag_, q, r);
+        return r;
+    };
+
+    big_int b = *this % mod;
+    if (b.neg_)
+        b += mod;
+
+    // sliding windows of up to w bits, which multiply once per window that
+    // ends in a one instead of once per set bit, with the odd powers of b
+    // up to 2^w. wider windows only pay for their table on longer exponents
+    const size_t w = bits > 512 ? 5 : bits > 128 ? 4 : bits > 24 ? 3 : 1;
+
+    std::vector<limbs_t> odd ((size_t)1 << (w - 1));
+    odd[0] = b.mag_;
+    if (odd.size () > 1) {
+        limbs_t sq = mulmod (b.mag_, b.mag_);
+        for (size_t k = 1; k < odd.size (); ++k)
+            odd[k] = mulmod (odd[k - 1], sq);
+    }
+
+    limbs_t ans = { 1 };
+    for (size_t i = bits; i-- > 0;) {
+        if (!bit (i)) {
+            ans = mulmod (ans, ans);
+            continue;
+        }
+
+        size_t j = i + 1 >= w ? i + 1 - w : 0;
+        while (!bit (j))
+            ++j;
+
+        size_t val = 0;
+        for (size_t k = i + 1; k-- > j;) {
+            ans = mulmod (ans, ans);
+            val = (val << 1) | bit (k);
+        }
+
+        ans = mulmod (ans, odd[val >> 1]);
+        i   = j;
+    }
+
+    limbs_t q;
+    divmod_ (ans, mod.mag_, q, ans);
+    return big_int (std::move (ans), false);
+}
+
+big_int
+big_int::gcd (big_int a, big_int b)
+{
+    while (!b.is_zero ()) {
+        a %= b;
+        std::swap (a, b);
+    }
+
+    a.neg_ = false;
+    return a;
+}
+
+bool
+big_int::is_zero () const
+{
+    return mag_.empty ();
+}
+
+bool
+big_int::is_neg () const
+{
+    return neg_;
+}
+
+size_t
+big_int::bits () const
+{
+    if (mag_.empty ())
+        return 0;
+
+    return 64 * mag_.size () - __builtin_clzll (mag_.back ());
+}
+
+std::string
+big_int::str () const
+{
+    if (mag_.empty ())
+        return "0";
+
+    // the limbs of the number in base DEC_BASE_, from the bottom up
+    limbs_t mag = mag_, chunks;
+    while (!mag.empty ())
+        chunks.push_back (div_small_ (mag, DEC_BASE_));
+
+    std::string str = neg_ ? "-" : "";
+    str += std::to_string (chunks.back ());
+
+    for (size_t i = chunks.size () - 1; i-- > 0;) {
+        std::string chunk = std::to_string (chunks[i]);
+        str.append (DEC_DIGITS_ - chunk.size (), '0');
+        str += chunk;
+    }
+
+    return str;
+}
+
+long double
+big_int::value () const
+{
+    // the top two limbs hold more bits than a long double does
+    long double val = 0;
+    size_t      lo  = mag_.size () > 2 ? mag_.size () - 2 : 0;
+    for (size_t i = mag_.size (); i-- > lo;)
+        val = std::ldexp (val, 64) + mag_[i];
+
+    val = std::ldexp (val, 64 * lo);
+    return neg_ ? -val : val;
+}
+
+} // namespace utl
+
+} // namespace ext
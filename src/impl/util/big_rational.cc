@@ -0,0 +1,112 @@
+#include <string>
+
+#include "util.hh"
+
+namespace ext
+{
+
+namespace utl
+{
+
+big_rational::big_rational (const big_int &n, const big_int &d)
+    : n_ (n), d_ (d)
+{
+    reduce_ ();
+}
+
+big_rational::big_rational (const rational_number &r)
+    : big_rational (big_int (r.n), big_int (r.d))
+{
+}
+
+void
+big_rational::reduce_ ()
+{
+    if (d_.is_neg ()) {
+        n_ = -n_;
+        d_ = -d_;
+    }
+
+    big_int gcd = big_int::gcd (n_, d_);
+    if (gcd != 1) {
+        n_ /= gcd;
+        d_ /= gcd;
+    }
+}
+
+big_rational
+big_rational::operator+ (const big_rational &other) const
+{
+    if (d_ == other.d_)
+        return big_rational (n_ + other.n_, d_);
+
+    return big_rational (n_ * other.d_ + other.n_ * d_, d_ * other.d_);
+}
+
+big_rational
+big_rational::operator- (const big_rational &other) const
+{
+    return *this + big_rational (-other.n_, other.d_);
+}
+
+big_rational
+big_rational::operator* (const big_rational &other) const
+{
+    return big_rational (n_ * other.n_, d_ * other.d_);
+}
+
+big_rational
+big_rational::operator/ (const big_rational &other) const
+{
+    return big_rational (n_ * other.d_, d_ * other.n_);
+}
+
+bool
+big_rational::operator< (const big_rational &other) const
+{
+    return n_ * other.d_ < other.n_ * d_;
+}
+
+bool
+big_rational::operator> (const big_rational &other) const
+{
+    return other < *this;
+}
+
+bool
+big_rational::operator== (const big_rational &other) const
+{
+    // both are in lowest terms
+    return n_ == other.n_ && d_ == other.d_;
+}
+
+const big_int &
+big_rational::num () const
+{
+    return n_;
+}
+
+const big_int &
+big_rational::den () const
+{
+    return d_;
+}
+
+std::string
+big_rational::str () const
+{
+    if (d_ == 1)
+        return n_.str ();
+
+    return n_.str () + "/" + d_.str ();
+}
+
+long double
+big_rational::value () const
+{
+    return n_.value () / d_.value ();
+}
+
+} // namespace utl
+
+} // namespace ext
@@ -0,0 +1,182 @@
+// https://en.wikipedia.org/wiki/Binary_GCD_algorithm
+
+#include <cstdint>
+#include <utility>
+
+#include "util.hh"
+
+namespace ext
+{
+
+namespace utl
+{
+
+__extension__ typedef unsigned __int128 uwide_t;
+
+static inline int
+ctz_ (uint64_t x)
+{
+    return __builtin_ctzll (x);
+}
+
+static inline int
+ctz_ (uwide_t x)
+{
+    uint64_t lo = (uint64_t)x;
+    return lo ? __builtin_ctzll (lo) : 64 + __builtin_ctzll (x >> 64);
+}
+
+/** @return The gcd of a and b, with shifts and subtractions only. */
+template <typename U>
+static U
+gcd_ (U a, U b)
+{
+    if (a == 0 || b == 0)
+        return a | b;
+
+    int shift = ctz_ (a | b);
+    a >>= ctz_ (a);
+
+    // a stays odd, and so does b after its zeros are shifted out
+    do {
+        b >>= ctz_ (b);
+        if (a > b)
+            std::swap (a, b);
+
+        b -= a;
+    } while (b != 0);
+
+    return a << shift;
+}
+
+lazy_rational
+lazy_rational::make_ (wide_t n, wide_t d)
+{
+    lazy_rational r;
+    r.n_ = d < 0 ? -n : n;
+    r.d_ = d < 0 ? -d : d;
+    r.fit_ ();
+
+    return r;
+}
+
+lazy_rational::lazy_rational (int64_t n, int64_t d)
+    : n_ (d < 0 ? -(wide_t)n : n), d_ (d < 0 ? -(wide_t)d : d)
+{
+}
+
+lazy_rational::lazy_rational (const rational_number &r)
+    : lazy_rational (r.n, r.d)
+{
+}
+
+void
+lazy_rational::fit_ ()
+{
+    if (n_ >= LIMIT_ || n_ <= -LIMIT_ || d_ >= LIMIT_)
+        reduce_ ();
+}
+
+void
+lazy_rational::reduce_ ()
+{
+    uwide_t un = n_ < 0 ? -(uwide_t)n_ : (uwide_t)n_;
+    uwide_t ud = d_;
+
+    // most fractions still fit in 64 bits when they are read
+    uwide_t gcd = (un >> 64) == 0 && (ud >> 64) == 0
+                      ? gcd_<uint64_t> (un, ud)
+                      : gcd_<uwide_t> (un, ud);
+
+    n_ /= (wide_t)gcd;
+    d_ /= (wide_t)gcd;
+}
+
+lazy_rational
+lazy_rational::operator+ (const lazy_rational &other) const
+{
+    // sums over a common denominator, as in accounting, stay exact for free
+    if (d_ == other.d_)
+        return make_ (n_ + other.n_, d_);
+
+    return make_ (n_ * other.d_ + other.n_ * d_, d_ * other.d_);
+}
+
+lazy_rational
+lazy_rational::operator- (const lazy_rational &other) const
+{
+    return *this + make_ (-other.n_, other.d_);
+}
+
+lazy_rational
+lazy_rational::operator* (const lazy_rational &other) const
+{
+    return make_ (n_ * other.n_, d_ * other.d_);
+}
+
+lazy_rational
+lazy_rational::operator/ (const lazy_rational &other) const
+{
+    return make_ (n_ * other.d_, d_ * other.n_);
+}
+
+lazy_rational &
+lazy_rational::operator+= (const lazy_rational &other)
+{
+    return *this = *this + other;
+}
+
+lazy_rational &
+lazy_rational::operator-= (const lazy_rational &other)
+{
+    return *this = *this - other;
+}
+
+lazy_rational &
+lazy_rational::operator*= (const lazy_rational &other)
+{
+    return *this = *this * other;
+}
+
+lazy_rational &
+lazy_rational::operator/= (const lazy_rational &other)
+{
+    return *this = *this / other;
+}
+
+bool
+lazy_rational::operator< (const lazy_rational &other) const
+{
+    return n_ * other.d_ < other.n_ * d_;
+}
+
+bool
+lazy_rational::operator> (const lazy_rational &other) const
+{
+    return n_ * other.d_ > other.n_ * d_;
+}
+
+bool
+lazy_rational::operator== (const lazy_rational &other) const
+{
+    return n_ * other.d_ == other.n_ * d_;
+}
+
+rational_number
+lazy_rational::reduced () const
+{
+    lazy_rational r = *this;
+    r.reduce_ ();
+
+    return { (int64_t)r.n_, (int64_t)r.d_ };
+}
+
+long double
+lazy_rational::value () const
+{
+    return (long double)n_ / (long double)d_;
+}
+
+} // namespace utl
+
+} // namespace ext
@@ -0,0 +1,241 @@
+// https://en.wikipedia.org/wiki/Binary_GCD_algorithm
+// https://en.algorithmica.org/hpc/algorithms/gcd/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "util.hh"
+
+namespace ext
+{
+
+namespace utl
+{
+
+__extension__ typedef __int128 wide_t;
+
+/** @return The gcd of a and b. The loop only branches on whether it is
+ * done, and the next shift is found while the minimum is taken. */
+static inline uint64_t
+gcd_ (uint64_t a, uint64_t b)
+{
+    if (a == 0 || b == 0)
+        return a | b;
+
+    int az = __builtin_ctzll (a), bz = __builtin_ctzll (b);
+    int shift = std::min (az, bz);
+
+    for (b >>= bz; a != 0;) {
+        a >>= az;
+
+        int64_t diff = b - a;
+        az           = __builtin_ctzll (diff | INT64_MIN); // diff may be 0
+        b            = std::min (a, b);
+        a            = diff < 0 ? -diff : diff;
+    }
+
+    return b << shift;
+}
+
+/** @return Whether n1 / d1 < n2 / d2, without rounding. */
+static inline bool
+less_ (int64_t n1, int64_t d1, int64_t n2, int64_t d2)
+{
+    wide_t lhs = (wide_t)n1 * d2, rhs = (wide_t)n2 * d1;
+
+    // the sign of the denominators flips the comparison
+    return (d1 < 0) != (d2 < 0) ? rhs < lhs : lhs < rhs;
+}
+
+rational_array::rational_array (size_t len) : n_ (len, 0), d_ (len, 1) {}
+
+rational_array::rational_array (const std::vector<rational_number> &vals)
+    : n_ (vals.size ()), d_ (vals.size ())
+{
+    for (size_t i = 0; i < vals.size (); ++i) {
+        n_[i] = vals[i].n;
+        d_[i] = vals[i].d;
+    }
+}
+
+void
+rational_array::push_back (const rational_number &val)
+{
+    n_.push_back (val.n);
+    d_.push_back (val.d);
+}
+
+rational_number
+rational_array::get (size_t idx) const
+{
+    return { n_[idx], d_[idx] };
+}
+
+void
+rational_array::set (size_t idx, const rational_number &val)
+{
+    n_[idx] = val.n;
+    d_[idx] = val.d;
+}
+
+void
+rational_array::add (const rational_array &other)
+{
+    const size_t   len = n_.size ();
+    int64_t       *n = n_.data (), *d = d_.data ();
+    const int64_t *on = other.n_.data (), *od = other.d_.data ();
+
+    // prices tend to share denominators, which then need no products
+    for (size_t i = 0; i < len; ++i) {
+        bool same = d[i] == od[i];
+
+        n[i] = same ? n[i] + on[i] : n[i] * od[i] + on[i] * d[i];
+        d[i] = same ? d[i] : d[i] * od[i];
+    }
+}
+
+void
+rational_array::sub (const rational_array &other)
+{
+    const size_t   len = n_.size ();
+    int64_t       *n = n_.data (), *d = d_.data ();
+    const int64_t *on = other.n_.data (), *od = other.d_.data ();
+
+    for (size_t i = 0; i < len; ++i) {
+        bool same = d[i] == od[i];
+
+        n[i] = same ? n[i] - on[i] : n[i] * od[i] - on[i] * d[i];
+        d[i] = same ? d[i] : d[i] * od[i];
+    }
+}
+
+void
+rational_array::mul (const rational_array &other)
+{
+    const size_t   len = n_.size ();
+    int64_t       *n = n_.data (), *d = d_.data ();
+    const int64_t *on = other.n_.data (), *od = other.d_.data ();
+
+    for (size_t i = 0; i < len; ++i) {
+        n[i] *= on[i];
+        d[i] *= od[i];
+    }
+}
+
+void
+rational_array::div (const rational_array &other)
+{
+    const size_t   len = n_.size ();
+    int64_t       *n = n_.data (), *d = d_.data ();
+    const int64_t *on = other.n_.data (), *od = other.d_.data ();
+
+    for (size_t i = 0; i < len; ++i) {
+        n[i] *= od[i];
+        d[i] *= on[i];
+    }
+}
+
+void
+rational_array::scale (const rational_number &factor)
+{
+    const size_t len = n_.size ();
+    int64_t     *n = n_.data (), *d = d_.data ();
+
+    for (size_t i = 0; i < len; ++i) {
+        n[i] *= factor.n;
+        d[i] *= factor.d;
+    }
+}
+
+std::vector<uint8_t>
+rational_array::less (const rational_array &other) const
+{
+    const size_t         len = n_.size ();
+    std::vector<uint8_t> ans (len);
+
+    for (size_t i = 0; i < len; ++i)
+        ans[i] = less_ (n_[i], d_[i], other.n_[i], other.d_[i]);
+
+    return ans;
+}
+
+void
+rational_array::reduce ()
+{
+    const size_t len = n_.size ();
+    int64_t     *n = n_.data (), *d = d_.data ();
+
+    // the divisions do not vectorize, so neither would lanes of gcds
+    for (size_t i = 0; i < len; ++i) {
+        uint64_t u = n[i] < 0 ? -(uint64_t)n[i] : n[i];
+        uint64_t v = d[i] < 0 ? -(uint64_t)d[i] : d[i];
+
+        int64_t sign = d[i] < 0 ? -1 : 1;
+        int64_t gcd  = std::max<uint64_t> (gcd_ (u, v), 1);
+
+        n[i] = sign * (n[i] / gcd);
+        d[i] = sign * (d[i] / gcd);
+    }
+}
+
+std::vector<size_t>
+rational_array::sort ()
+{
+    const size_t len = n_.size ();
+
+    // the key rounds the numerator, the denominator and the quotient, so its
+    // relative error is below 3.01 * 2^-53, and two keys further apart than
+    // 2^-50 of the larger one are in the same order as the exact values.
+    // only closer keys need the exact comparison, which makes the comparator
+    // the exact order everywhere
+    static constexpr double TOL = 0x1p-50;
+
+    std::vector<std::pair<double, size_t> > key;
+    std::vector<size_t>                     zero;
+    key.reserve (len);
+
+    for (size_t i = 0; i < len; ++i)
+        if (d_[i] == 0)
+            zero.push_back (i);
+        else
+            key.push_back ({ (double)n_[i] / (double)d_[i], i });
+
+    std::sort (key.begin (), key.end (), [&] (const auto &a, const auto &b) {
+        double gap = std::max (std::fabs (a.first), std::fabs (b.first));
+        if (std::fabs (a.first - b.first) > TOL * gap)
+            return a.first < b.first;
+
+        return less_ (n_[a.second], d_[a.second], n_[b.second],
+                      d_[b.second]);
+    });
+
+    // elements without a value go last, in their original order
+    for (size_t i : zero)
+        key.push_back ({ 0, i });
+
+    std::vector<size_t>  idx (len);
+    std::vector<int64_t> n (len), d (len);
+    for (size_t i = 0; i < len; ++i) {
+        idx[i] = key[i].second;
+        n[i]   = n_[idx[i]];
+        d[i]   = d_[idx[i]];
+    }
+
+    n_.swap (n);
+    d_.swap (d);
+
+    return idx;
+}
+
+size_t
+rational_array::size () const
+{
+    return n_.size ();
+}
+
+} // namespace utl
+
+} // namespace ext
@@ -8,15 +8,36 @@ namespace ext
 namespace utl
 {
 
+__extension__ typedef __int128 wide_t;
+
+/** @return The gcd of a and b. */
+static wide_t
+gcd_ (wide_t a, wide_t b)
+{
+    a = a < 0 ? -a : a;
+    b = b < 0 ? -b : b;
+
+    while (b != 0) {
+        wide_t r = a % b;
+        a        = b;
+        b        = r;
+    }
+
+    return a;
+}
+
 rational_number
 rational_number::operator+ (const rational_number &other) const
 {
-    rational_number rnum
-        = { (this->n * other.d) + (other.n * this->d), this->d * other.d };
-    int64_t gcd = std::gcd (rnum.n, rnum.d);
-    rnum.n      = rnum.n / gcd;
-    rnum.d      = rnum.d / gcd;
-    return rnum;
+    // the sum is formed in 128 bits, where the cross products can not
+    // overflow, so only the reduced result has to fit in 64 bits
+    int64_t dgcd = std::gcd (this->d, other.d);
+    wide_t  n    = (wide_t)this->n * (other.d / dgcd)
+                 + (wide_t)other.n * (this->d / dgcd);
+    wide_t  d    = (wide_t)(this->d / dgcd) * other.d;
+    wide_t  gcd  = gcd_ (n, d);
+
+    return { (int64_t)(n / gcd), (int64_t)(d / gcd) };
 }
 
 rational_number
@@ -29,11 +50,15 @@ rational_number::operator- (const rational_number &other) const
 rational_number
 rational_number::operator* (const rational_number &other) const
 {
-    rational_number rnum = { this->n * other.n, this->d * other.d };
-    int64_t         gcd  = std::gcd (rnum.n, rnum.d);
-    rnum.n               = rnum.n / gcd;
-    rnum.d               = rnum.d / gcd;
-    return rnum;
+    // cancel across before multiplying, so the product is already reduced
+    if (this->n == 0 || other.n == 0)
+        return { 0, 1 };
+
+    int64_t g1 = std::gcd (this->n, other.d);
+    int64_t g2 = std::gcd (other.n, this->d);
+
+    return { (this->n / g1) * (other.n / g2),
+             (this->d / g2) * (other.d / g1) };
 }
 
 rational_number
@@ -46,13 +71,13 @@ rational_number::operator/ (const rational_number &other) const
 bool
 rational_number::operator< (const rational_number &other) const
 {
-    return (this->n * other.d) < (other.n * this->d);
+    return (wide_t)this->n * other.d < (wide_t)other.n * this->d;
 }
 
 bool
 rational_number::operator> (const rational_number &other) const
 {
-    return (this->n * other.d) > (other.n * this->d);
+    return (wide_t)this->n * other.d > (wide_t)other.n * this->d;
 }
 
 long double
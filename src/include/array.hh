@@ -2,8 +2,14 @@
 #ifndef ARRAY_HH
 #define ARRAY_HH
 
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "tree.hh"
+
 namespace ext
 {
 
@@ -12,11 +18,143 @@ namespace arr
 
 enum sqtype_e { INCR, DECR, NDCR, NICR };
 
+/** @return The longest subsequence of type SQ in O(N log N). Ties are
+ * broken towards the subsequence that ends last. */
+template <sqtype_e SQ, typename T>
+std::vector<T> lis (const std::vector<T> &arr);
+
 template <typename T>
 std::vector<T> lis (const std::vector<T> &arr, const sqtype_e &sqtype);
 
+/** Computes the same subsequence as lis on up to threads threads, or on all
+ * hardware threads if threads is 0. Elements are assigned the length of the
+ * longest subsequence ending in them in one parallel phase per length, so
+ * this scales best when the subsequence is short relative to the array.
+ * @return The longest subsequence of type sqtype. */
+template <typename T>
+std::vector<T> par_lis (const std::vector<T> &arr, const sqtype_e &sqtype,
+                        size_t threads = 0);
+
 template <typename T> T cnt_lis (const std::vector<T> &arr);
 
+/** Finds a longest common subsequence with Hunt-Szymanski in
+ * O((r + n) log n), where r is the number of pairs of equal elements, by
+ * reducing it to lis over the positions of the matches. Best when few pairs
+ * match, as in diffs.
+ * @return A longest common subsequence of a and b. */
+template <typename T>
+std::vector<T> lcs (const std::vector<T> &a, const std::vector<T> &b);
+
+/** Computes the length of a longest common subsequence with Hyyro's
+ * bit-parallel algorithm in O(n m / 64) time, plus O(sigma n / 64) memory for
+ * the match masks of the sigma distinct elements of a. Best for small
+ * alphabets where most pairs match.
+ * @return The length of a longest common subsequence of a and b. */
+template <typename T>
+size_t lcs_length (const std::vector<T> &a, const std::vector<T> &b);
+
+/** Maintains the longest subsequence of type SQ of a stream of values in
+ * O(log N) per value. If keep_seq is false only the tails of the
+ * subsequences are stored, so memory is O(length) instead of O(N), but the
+ * subsequence can not be reconstructed. */
+template <typename T, sqtype_e SQ = INCR> class online_lis final
+{
+    // d_[l] is the best element at which a subsequence of length l + 1 ends
+    std::vector<T> d_;
+
+    // only used if keep_seq_. idxs_[l] is the index of d_[l] in vals_, and
+    // prev_[i] is the index of the element before vals_[i]
+    bool                keep_seq_;
+    std::vector<T>      vals_;
+    std::vector<size_t> idxs_;
+    std::vector<size_t> prev_;
+
+public:
+    online_lis (bool keep_seq = true);
+
+    /** Appends val to the stream.
+     * @return The length of the longest subsequence so far. */
+    size_t push (const T &val);
+
+    /** @return The length of the longest subsequence so far. */
+    size_t length () const;
+
+    /** @return The longest subsequence so far, the same one lis would
+     * return, or nothing if keep_seq is false. */
+    std::vector<T> reconstruct () const;
+};
+
+/** Answers the length of the longest subsequence of type sqtype in any range
+ * [start, end) in O(log N), after O(N log^2 N) preprocessing. The seaweed
+ * braid of the array is built by splitting the values in two and merging the
+ * halves with the steady ant, and only where each top seaweed ends is kept,
+ * in a wavelet matrix. */
+template <typename T> class range_lis final
+{
+    // end_[i] is the bottom column where the seaweed that enters column i
+    // from the top leaves, or N if it leaves on the right
+    wvlt::matrix<uint32_t> end_;
+
+    static std::vector<uint32_t> ends_ (const std::vector<T> &arr,
+                                        const sqtype_e       &sqtype);
+
+public:
+    range_lis (const std::vector<T> &arr, const sqtype_e &sqtype);
+
+    /** @return The length of the longest subsequence in the range
+     * [start, end). */
+    size_t query (size_t start, size_t end) const;
+
+    /** @return The length of the array. */
+    size_t size () const;
+};
+
+/** Counts the longest strictly increasing subsequences in O(N log N). The
+ * count does not depend on T; it is taken modulo mod, or modulo 2^64 if mod is
+ * 0.
+ * @return The number of distinct LIS, as cnt_lis counts them. */
+template <typename T>
+uint64_t cnt_lis_nlogn (const std::vector<T> &arr, uint64_t mod = 0);
+
+/** @return The order in which Mo's algorithm should answer the ranges
+ * [start, end) in qs over an array of length len. The ranges are sorted along
+ * a Hilbert curve, which keeps the total pointer movement at O(n sqrt q)
+ * and is usually faster than sorting by blocks. */
+std::vector<size_t>
+mo_order (const std::vector<std::pair<size_t, size_t> > &qs, size_t len);
+
+/** Answers the ranges [start, end) in qs offline with Mo's algorithm. A
+ * window over the array is kept by moving its ends one element at a time:
+ * add (idx) and remove (idx) must insert and erase the element at idx, and
+ * answer () must return the answer of the current window. Elements are
+ * always added before others are removed, so the window is never inverted.
+ * @return The answer to each range, in the order of qs. */
+template <typename Add, typename Remove, typename Answer>
+std::vector<std::invoke_result_t<Answer &> >
+mo (const std::vector<std::pair<size_t, size_t> > &qs, size_t len, Add add,
+    Remove remove, Answer answer)
+{
+    std::vector<std::invoke_result_t<Answer &> > ans (qs.size ());
+
+    size_t l = 0, r = 0; // the window is [l, r)
+    for (size_t q : mo_order (qs, len)) {
+        auto [start, end] = qs[q];
+
+        while (l > start)
+            add (--l);
+        while (r < end)
+            add (r++);
+        while (l < start)
+            remove (l++);
+        while (r > end)
+            remove (--r);
+
+        ans[q] = answer ();
+    }
+
+    return ans;
+}
+
 } // namespace arr
 
 } // namespace ext
@@ -2,6 +2,7 @@
 #ifndef GRAPH_HH
 #define GRAPH_HH
 
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -2,11 +2,123 @@
 #ifndef MISC_HH
 #define MISC_HH
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 namespace ext
 {
 
 void get_winsz (int *rows, int *cols);
 
+namespace modr
+{
+
+/** Multiplies modulo a fixed odd mod below 2^64 in Montgomery form, where x
+ * is stored as x 2^64 mod mod, so that a product is reduced with two
+ * multiplications instead of a division. */
+class montgomery final
+{
+    __extension__ typedef unsigned __int128 wide_t;
+
+    uint64_t mod_;
+    uint64_t inv_; // mod_ inv_ = 1 modulo 2^64
+    uint64_t r2_;  // 2^128 modulo mod_
+    uint64_t one_; // 1 in Montgomery form
+
+    /** @return t 2^-64 modulo mod_, for t < mod_ 2^64. */
+    uint64_t redc_ (wide_t t) const;
+
+public:
+    montgomery (uint64_t mod);
+
+    /** @return x in Montgomery form. */
+    uint64_t to (uint64_t x) const;
+
+    /** @return The value of x, which is in Montgomery form. */
+    uint64_t from (uint64_t x) const;
+
+    /** @return a b, where both and the result are in Montgomery form. */
+    uint64_t mul (uint64_t a, uint64_t b) const;
+
+    /** @return base^exp modulo mod, in and out of Montgomery form. */
+    uint64_t pow (uint64_t base, uint64_t exp) const;
+
+    /** Raises every base to exp, interleaving the squarings of several
+     * bases so that their multiplications overlap.
+     * @return base^exp modulo mod for every base, in the same order. */
+    std::vector<uint64_t> pow (const std::vector<uint64_t> &bases,
+                               uint64_t                     exp) const;
+
+    uint64_t mod () const;
+};
+
+/** Multiplies modulo any fixed mod from 1 up to 2^64 - 1 with Barrett
+ * reduction, in Moller and Granlund's form, which replaces the division by
+ * two multiplications with a precomputed reciprocal. Slower than
+ * montgomery, but works for even moduli and needs no conversion. */
+class barrett final
+{
+    __extension__ typedef unsigned __int128 wide_t;
+
+    uint64_t mod_;
+    int      shift_; // mod_ << shift_ has its top bit set
+    uint64_t inv_;   // floor ((2^128 - 1) / (mod_ << shift_)) - 2^64
+
+public:
+    barrett (uint64_t mod);
+
+    /** @return x modulo mod, for x below mod 2^64, as the product of two
+     * reduced values is. */
+    uint64_t reduce (wide_t x) const;
+
+    /** Values need no conversion, but these give barrett the interface of
+     * montgomery. */
+    uint64_t to (uint64_t x) const;
+    uint64_t from (uint64_t x) const;
+
+    /** @return a b modulo mod, for a and b below mod. */
+    uint64_t mul (uint64_t a, uint64_t b) const;
+
+    /** @return base^exp modulo mod. */
+    uint64_t pow (uint64_t base, uint64_t exp) const;
+
+    uint64_t mod () const;
+};
+
+/** Raises one base to many exponents modulo the modulus of a montgomery or
+ * barrett context. The powers base^(d 2^(w i)) of every w-bit digit d are
+ * tabulated once, so that each exponent then takes one multiplication per
+ * digit and no squarings: 8 instead of about 96 for the default 8-bit
+ * digits, with a table of 16 KiB. */
+template <typename Ctx> class fixed_base final
+{
+    Ctx                   ctx_;
+    size_t                window_;
+    std::vector<uint64_t> table_; // table_[(i << window_) + d], as in Ctx
+
+public:
+    /** window is the width w of the digits, from 1 to 16. */
+    fixed_base (const Ctx &ctx, uint64_t base, size_t window = 8);
+
+    /** @return base^exp modulo mod. */
+    uint64_t pow (uint64_t exp) const;
+};
+
+/** Raises base to exp modulo the modulus of a montgomery or barrett context
+ * with sliding windows of up to window bits, from 1 to 8, for when the base
+ * changes too often for fixed_base. The odd powers of base below 2^window
+ * are tabulated, so that a window of ones costs one multiplication instead
+ * of one per set bit: about 64 / (window + 1) instead of 32. The 64
+ * squarings stay, and pow already hides its multiplications behind them,
+ * so this only wins when multiplications, not their latency, are the cost.
+ * @return base^exp modulo mod. */
+template <typename Ctx>
+uint64_t sliding_pow (const Ctx &ctx, uint64_t base, uint64_t exp,
+                      size_t window = 4);
+
+} // namespace modr
+
 } // namespace ext
 
 #endif
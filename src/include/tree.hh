@@ -2,13 +2,41 @@
 #ifndef TREE_HH
 #define TREE_HH
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
 #include <functional>
+#include <limits>
+#include <mutex>
+#include <utility>
 #include <vector>
 
+#include "util.hh"
+
 namespace ext
 {
 
+/** Header of a tree snapshot file. It is followed by the tree array and, for
+ * lazy trees, the lazy array, written as they are laid out in memory. The
+ * header is 64 bytes long so that the arrays stay aligned when the file is
+ * mapped. */
+struct snapshot_t {
+    char     magic[4];  // "SGTR" for segtr, "LZST" for lz_segtr
+    uint32_t version;   // SNAPSHOT_VERSION when the file was written
+    uint32_t elem_size; // sizeof (T)
+    uint32_t is_signed;
+    uint32_t op;        // treeop_e of a lazy tree
+    uint32_t reserved;
+    uint64_t len;
+    uint64_t tree_len;
+    uint64_t lazy_len;
+    uint64_t dft; // bytes of the default value
+    uint64_t padding;
+};
+
+static constexpr uint32_t SNAPSHOT_VERSION = 1;
+
 namespace segtr
 {
 
@@ -37,10 +65,443 @@ public:
 
     /** @return A query of the range [start, end) */
     T query (size_t start, size_t end);
+
+    /** Descends the tree once in O(log n). pred must be monotone and hold for
+     * the default value.
+     * @return The largest end such that pred (query (start, end)) holds. */
+    size_t max_right (size_t start,
+                      std::function<bool (const T &)> const &pred);
+
+    /** Descends the tree once in O(log n). pred must be monotone and hold for
+     * the default value.
+     * @return The smallest start such that pred (query (start, end)) holds. */
+    size_t min_left (size_t end, std::function<bool (const T &)> const &pred);
+
+    /** Writes a snapshot of the tree to path.
+     * @return If the snapshot was written successfully. */
+    bool save (const char *path) const;
+};
+
+/** A segment tree over N elements whose size is known at compile time. The
+ * nodes live in a std::array, so the tree does no heap allocation and can be
+ * embedded in other objects, and every loop has a constant trip count.
+ * Combine is a default constructible functor such as std::plus<T>. Unlike
+ * tree, the leaves start at a power of two so the tree is perfect, and
+ * queries keep the order of the elements. */
+template <typename T, size_t N, typename Combine> class static_tree final
+{
+    static constexpr size_t SIZE_ = utl::next_p2 (N);
+    static constexpr size_t LOG_  = __builtin_ctzll (SIZE_);
+
+    // same layout as tree, with the leaves at [SIZE_, SIZE_ + N)
+    std::array<T, SIZE_ << 1> tree_;
+    T                         DEFAULT_;
+
+    [[no_unique_address]] Combine combine_;
+
+public:
+    constexpr static_tree (const T dft) : DEFAULT_ (dft) { tree_.fill (dft); }
+
+    /** Builds the tree from the first N elements of arr in O(N). */
+    constexpr static_tree (const T dft, const std::array<T, N> &arr)
+        : static_tree (dft)
+    {
+        for (size_t i = 0; i < N; ++i)
+            tree_[SIZE_ + i] = arr[i];
+
+        for (size_t i = SIZE_ - 1; i > 0; --i)
+            tree_[i] = combine_ (tree_[i << 1], tree_[(i << 1) | 1]);
+    }
+
+    /** Sets the value at idx to val */
+    constexpr void
+    set (size_t idx, T val)
+    {
+        idx += SIZE_;
+        tree_[idx] = val;
+
+        for (size_t k = 0; k < LOG_; ++k) {
+            idx >>= 1;
+            tree_[idx] = combine_ (tree_[idx << 1], tree_[(idx << 1) | 1]);
+        }
+    }
+
+    /** @return The element at idx. */
+    constexpr const T &
+    get (size_t idx) const
+    {
+        return tree_[SIZE_ + idx];
+    }
+
+    /** @return A query of the range [start, end) */
+    constexpr T
+    query (size_t start, size_t end) const
+    {
+        T lhs = DEFAULT_, rhs = DEFAULT_;
+        for (start += SIZE_, end += SIZE_; start < end;
+             start >>= 1, end >>= 1) {
+            if (start & 1)
+                lhs = combine_ (lhs, tree_[start++]);
+
+            if (end & 1)
+                rhs = combine_ (tree_[--end], rhs);
+        }
+
+        return combine_ (lhs, rhs);
+    }
+
+    /** @return A query of the whole array. */
+    constexpr const T &
+    all () const
+    {
+        return tree_[1];
+    }
+
+    /** @return The length of the array. */
+    static constexpr size_t
+    size ()
+    {
+        return N;
+    }
+};
+
+/** A segment tree with the same layout as tree that can be read from any
+ * number of threads while it is being written to. Writers are serialized with
+ * a mutex; readers never take a lock. Instead they read the tree under a
+ * sequence lock and retry if a write overlapped, so every query sees the tree
+ * as it was between two calls to set. */
+template <typename T> class concurrent_tree final
+{
+    const T DEFAULT_;
+
+    // same layout as tree::tree_. nodes are atomic so that a reader racing a
+    // writer reads stale values instead of torn ones
+    std::vector<std::atomic<T> > tree_;
+    size_t                       len_;
+
+    // odd while a write is in progress
+    std::atomic<uint64_t> seq_;
+    std::mutex            write_;
+
+    std::function<T (const T &, const T &)> combine_;
+
+    /** @return A query of the range [start, end) without a snapshot check. */
+    T query_ (size_t start, size_t end) const;
+
+public:
+    concurrent_tree (size_t len, const T dft,
+                     std::function<T (const T &, const T &)> const &combine);
+
+    /** Sets the value at idx to val. */
+    void set (size_t idx, T val);
+
+    /** @return A query of the range [start, end) on a consistent snapshot. */
+    T query (size_t start, size_t end) const;
+};
+
+/** A tree loaded from a snapshot written by tree::save. The file is mapped
+ * into memory instead of being read, so opening is O(1) and pages are only
+ * loaded once a query touches them. Calls to set modify a private
+ * copy-on-write mapping and are never written back to the file. */
+template <typename T> class mapped_tree final
+{
+    T DEFAULT_;
+
+    void  *map_;     // start of the mapping
+    size_t map_len_; // length of the mapping in bytes
+    T     *tree_;    // same layout as tree::tree_, inside the mapping
+    size_t len_;
+
+    std::function<T (const T &, const T &)> combine_;
+
+    void close_ ();
+
+public:
+    mapped_tree ();
+    ~mapped_tree ();
+
+    mapped_tree (const mapped_tree &)            = delete;
+    mapped_tree &operator= (const mapped_tree &) = delete;
+
+    /** Maps the snapshot at path. combine must be the function the tree was
+     * built with.
+     * @return If the file is a valid snapshot of a tree<T>. */
+    bool open (const char *path,
+               std::function<T (const T &, const T &)> const &combine);
+
+    /** Sets the value at idx to val */
+    void set (size_t idx, T val);
+
+    /** @return A query of the range [start, end) */
+    T query (size_t start, size_t end) const;
+
+    /** @return The length of the array. */
+    size_t size () const;
 };
 
 } // namespace segtr
 
+namespace fwtr
+{
+
+/** A binary indexed tree that can answer point update and range sum queries
+ * using len + 1 elements of storage. */
+template <typename T> class tree final
+{
+    // tree_[i] stores the sum of the elements in (i - lowbit(i), i], 1-indexed
+    std::vector<T> tree_;
+    size_t         len_;
+
+public:
+    tree (size_t len);
+
+    /** Builds the tree from arr in O(n). */
+    tree (const std::vector<T> &arr);
+
+    /** Adds val to the element at idx. */
+    void add (size_t idx, T val);
+
+    /** @return The sum of the range [0, end). */
+    T prefix (size_t end) const;
+
+    /** @return The sum of the range [start, end). */
+    T query (size_t start, size_t end) const;
+
+    /** @return The smallest idx such that the sum of [0, idx] is at least
+     * val, or len if there is none. All elements must be non-negative. */
+    size_t lower_bound (T val) const;
+};
+
+/** A pair of binary indexed trees that can answer range update and range sum
+ * queries. */
+template <typename T> class range_tree final
+{
+    // the prefix sum of [0, p) is p * prefix(add_, p) - prefix(sub_, p)
+    tree<T> add_;
+    tree<T> sub_;
+    size_t  len_;
+
+public:
+    range_tree (size_t len);
+
+    /** Adds val to every element in the range [start, end). */
+    void upd (size_t start, size_t end, T val);
+
+    /** @return The sum of the range [0, end). */
+    T prefix (size_t end) const;
+
+    /** @return The sum of the range [start, end). */
+    T query (size_t start, size_t end) const;
+};
+
+/** A binary indexed tree over a dense grid that can answer point update and
+ * rectangle sum queries in O(log rows * log cols). */
+template <typename T> class tree_2d final
+{
+    // row major, (rows + 1) * (cols + 1) elements, 1-indexed on both axes
+    std::vector<T> tree_;
+    size_t         rows_;
+    size_t         cols_;
+
+public:
+    tree_2d (size_t rows, size_t cols);
+
+    /** Adds val to the element at (row, col). */
+    void add (size_t row, size_t col, T val);
+
+    /** @return The sum of the rectangle [0, row) x [0, col). */
+    T prefix (size_t row, size_t col) const;
+
+    /** @return The sum of the rectangle [r0, r1) x [c0, c1). */
+    T query (size_t r0, size_t c0, size_t r1, size_t c1) const;
+};
+
+/** An offline binary indexed tree over sparse points. Every point that will
+ * ever be updated is given up front; each node of the tree over x stores the
+ * sorted y coordinates of the points it covers together with its own binary
+ * indexed tree over them, so memory is O(n log n) regardless of the size of
+ * the coordinates. */
+template <typename T> class sparse_2d final
+{
+    std::vector<uint64_t> xs_; // sorted unique x coordinates
+
+    // the y coordinates and tree of node i are ys_[off_[i - 1], off_[i]) and
+    // tree_[off_[i - 1] + i - 1, off_[i] + i), where the extra element per
+    // node is the unused index 0 of its tree
+    std::vector<size_t>   off_;
+    std::vector<uint64_t> ys_;
+    std::vector<T>        tree_;
+
+public:
+    sparse_2d (const std::vector<std::pair<uint64_t, uint64_t> > &pts);
+
+    /** Adds val to the point (x, y), which must have been passed to the
+     * constructor. */
+    void add (uint64_t x, uint64_t y, T val);
+
+    /** @return The sum of the points in [0, x) x [0, y). */
+    T prefix (uint64_t x, uint64_t y) const;
+
+    /** @return The sum of the points in [x0, x1) x [y0, y1). */
+    T query (uint64_t x0, uint64_t y0, uint64_t x1, uint64_t y1) const;
+};
+
+} // namespace fwtr
+
+namespace rmq
+{
+
+/** An immutable structure that answers idempotent range queries (min, max,
+ * gcd, ...) in O(1) after an O(n log n) build. */
+template <typename T> class sparse_table final
+{
+    // table_[k * len + i] is the combination of the range [i, i + 2^k)
+    std::vector<T> table_;
+    size_t         len_;
+
+    std::function<T (const T &, const T &)> combine_;
+
+public:
+    sparse_table (const std::vector<T> &arr,
+                  std::function<T (const T &, const T &)> const &combine);
+
+    /** @return A query of the non-empty range [start, end). */
+    T query (size_t start, size_t end) const;
+};
+
+/** An immutable range minimum structure with O(n) memory and O(1) queries.
+ * The array is split into blocks of 64 elements; queries inside a block use a
+ * bitmask of the monotonic stack and queries across blocks use a sparse table
+ * over the block minima. */
+template <typename T> class block_table final
+{
+    static constexpr size_t BLOCK_ = 64;
+
+    std::vector<T> arr_;
+
+    // bit j of mask_[i] is set if element j of i's block is the best element
+    // of some range [j, i]
+    std::vector<uint64_t> mask_;
+
+    std::function<bool (const T &, const T &)> cmp_;
+
+    // the best element of each block
+    sparse_table<T> blocks_;
+
+    /** @return The best element of [start, end] within a single block. */
+    inline T in_block_ (size_t start, size_t end) const;
+
+    /** Fills mask_ and returns the best element of each block. */
+    std::vector<T> build_ ();
+
+public:
+    /** @param `cmp`: returns true if the first argument is strictly better
+     * than the second, e.g. std::less<T> () for range minimum queries. */
+    block_table (const std::vector<T> &arr,
+                 std::function<bool (const T &, const T &)> const &cmp);
+
+    /** @return A query of the non-empty range [start, end). */
+    T query (size_t start, size_t end) const;
+};
+
+} // namespace rmq
+
+namespace wvlt
+{
+
+/** An immutable bit vector with O(1) rank and O(log n) select. A cumulative
+ * count is stored for every 256 bits, so the overhead is 25%. */
+class bit_vector final
+{
+    static constexpr size_t BLOCK_ = 256;
+
+    std::vector<uint64_t> words_;
+    std::vector<uint64_t> rank_; // number of ones before each block
+    size_t                len_;
+
+public:
+    bit_vector (size_t len = 0);
+
+    /** Sets the bit at idx. Must be called before build. */
+    void set (size_t idx);
+
+    /** Fills the rank directory. */
+    void build ();
+
+    /** @return The bit at idx. */
+    bool get (size_t idx) const;
+
+    /** @return The number of ones in the range [0, end). */
+    size_t rank1 (size_t end) const;
+
+    /** @return The number of zeros in the range [0, end). */
+    size_t rank0 (size_t end) const;
+
+    /** @return The position of the k-th one (0-indexed), or len if there is
+     * none. */
+    size_t select1 (size_t k) const;
+
+    /** @return The position of the k-th zero (0-indexed), or len if there is
+     * none. */
+    size_t select0 (size_t k) const;
+
+    /** @return The number of bits. */
+    size_t size () const;
+};
+
+/** A static wavelet matrix over an integer array that answers access, rank,
+ * select, range k-th smallest and range frequency queries in O(log sigma),
+ * where sigma is the largest value minus the smallest, using about
+ * n log sigma bits. Signed values are ordered by flipping their sign bit,
+ * and every key is stored relative to the smallest one. */
+template <typename T> class matrix final
+{
+    // level l splits on bit (log_ - 1 - l) of the key. the elements whose bit
+    // is 0 are stably moved before those whose bit is 1 for the next level,
+    // and zeros_[l] is the number of them
+    std::vector<bit_vector> level_;
+    std::vector<size_t>     zeros_;
+    size_t                  len_;
+    size_t                  log_;
+    uint64_t                base_; // the smallest key, subtracted from all
+
+    /** @return The unsigned key of val, which has the same order. */
+    static inline uint64_t key_ (T val);
+
+    /** @return The value of key. */
+    static inline T val_ (uint64_t key);
+
+    /** @return The number of elements in [start, end) whose key, relative
+     * to base_, is less than key. */
+    size_t count_less_ (size_t start, size_t end, uint64_t key) const;
+
+public:
+    matrix (const std::vector<T> &arr);
+
+    /** @return The element at idx. */
+    T access (size_t idx) const;
+
+    /** @return The number of occurrences of val in the range [0, end). */
+    size_t rank (T val, size_t end) const;
+
+    /** @return The position of the k-th occurrence (0-indexed) of val, or
+     * len if there is none. */
+    size_t select (T val, size_t k) const;
+
+    /** @return The k-th smallest element (0-indexed) in the range
+     * [start, end). k must be less than end - start. */
+    T kth_smallest (size_t start, size_t end, size_t k) const;
+
+    /** @return The number of elements in the range [start, end) whose value
+     * is in [lo, hi). */
+    size_t range_freq (size_t start, size_t end, T lo, T hi) const;
+
+    /** @return The length of the array. */
+    size_t size () const;
+};
+
+} // namespace wvlt
+
 namespace lz_segtr
 {
 
@@ -67,6 +528,7 @@ template <typename T> class tree final
     std::vector<T>           tree_; // length of this is 2 * len
     std::vector<query_t<T> > lazy_;
     size_t                   len_; // simulated "length" of the array
+    treeop_e                 type_;
 
     std::function<T (const T &, const T &)> combine_;
     std::function<T (const T &, const T &)> upd_upstream_;
@@ -86,6 +548,13 @@ template <typename T> class tree final
 
     T query_ (size_t start, size_t end, size_t pos_, size_t lb_, size_t rb_);
 
+    size_t max_right_ (size_t start,
+                       std::function<bool (const T &)> const &pred, T *acc,
+                       size_t pos_, size_t lb_, size_t rb_);
+
+    size_t min_left_ (size_t end, std::function<bool (const T &)> const &pred,
+                      T *acc, size_t pos_, size_t lb_, size_t rb_);
+
 public:
     tree (size_t len, T dft, std::vector<T> arr, treeop_e type);
 
@@ -95,10 +564,558 @@ public:
     /** @return Queries the range [start, end) recursively with O(log n) time
      * complexity.*/
     T query (size_t start, size_t end);
+
+    /** Descends the tree once in O(log n). pred must be monotone and hold for
+     * the default value.
+     * @return The first idx such that pred (query (start, idx)) does not
+     * hold, or len if there is none. */
+    size_t max_right (size_t start,
+                      std::function<bool (const T &)> const &pred);
+
+    /** Descends the tree once in O(log n). pred must be monotone and hold for
+     * the default value.
+     * @return The smallest idx such that pred (query (idx, end)) holds, or
+     * end + 1 if there is none. */
+    size_t min_left (size_t end, std::function<bool (const T &)> const &pred);
+
+    /** Writes a snapshot of the tree, including pending tags, to path.
+     * @return If the snapshot was written successfully. */
+    bool save (const char *path) const;
+};
+
+/** A read-only tree loaded from a snapshot written by tree::save. The file is
+ * mapped into memory instead of being read, so opening is O(1). Queries do
+ * not push tags down; instead the pending tags of the ancestors are composed
+ * on the way down and applied to the nodes that are returned. */
+template <typename T> class mapped_tree final
+{
+    T DEFAULT_;
+
+    void             *map_;     // start of the mapping
+    size_t            map_len_; // length of the mapping in bytes
+    const T          *tree_;    // same layout as tree::tree_
+    const query_t<T> *lazy_;    // same layout as tree::lazy_
+    size_t            len_;
+    treeop_e          type_;
+
+    void close_ ();
+
+    inline T combine_ (const T &x, const T &y) const;
+
+    /** @return The value of a node of len elements after applying q. */
+    inline T apply_ (const query_t<T> &q, const T &val, size_t len) const;
+
+    /** @return The tag equivalent to applying older and then newer. */
+    inline query_t<T> compose_ (const query_t<T> &newer,
+                                const query_t<T> &older) const;
+
+    T query_ (size_t start, size_t end, const query_t<T> &tag, size_t pos_,
+              size_t lb_, size_t rb_) const;
+
+public:
+    mapped_tree ();
+    ~mapped_tree ();
+
+    mapped_tree (const mapped_tree &)            = delete;
+    mapped_tree &operator= (const mapped_tree &) = delete;
+
+    /** Maps the snapshot at path.
+     * @return If the file is a valid snapshot of a tree<T>. */
+    bool open (const char *path);
+
+    /** @return A query of the range [start, end]. */
+    T query (size_t start, size_t end) const;
+
+    /** @return The length of the array. */
+    size_t size () const;
+};
+
+/** A non-recursive lazy propagation segment tree with the same operations as
+ * tree. Tags are pushed along the two boundary paths of a range before it is
+ * updated or queried bottom-up, and the tree operation is dispatched with a
+ * switch instead of through std::function. */
+template <typename T> class iter_tree final
+{
+    const T DEFAULT_;
+
+    // same layout as tree, but the leaves always start at index size_, which
+    // is the smallest power of two that is at least len. lazy_ only holds
+    // tags for the internal nodes [1, size_)
+
+    std::vector<T>           tree_; // length of this is 2 * size_
+    std::vector<query_t<T> > lazy_;
+    size_t                   len_;
+    size_t                   size_;
+    size_t                   log_; // depth of the leaves
+
+    treeop_e type_;
+
+    inline T combine_ (const T &x, const T &y) const;
+
+    inline void pushup_ (size_t pos);
+
+    inline void pushdown_ (size_t pos);
+
+    inline void apply_ (size_t pos, const query_t<T> &q);
+
+public:
+    iter_tree (size_t len, T dft, const std::vector<T> &arr, treeop_e type);
+
+    /** Adds or sets a value to the range of elements [start, end]. */
+    void upd (size_t start, size_t end, T val, qtype_e qtype);
+
+    /** @return A query of the range [start, end]. */
+    T query (size_t start, size_t end);
+};
+
+/** iter_tree with each internal node's aggregate and lazy tag stored next to
+ * each other, so a pushdown or pushup touches one node array instead of two
+ * distant ones. */
+template <typename T> class fused_tree final
+{
+    // a tag is either "add tag" or "set tag"; an empty tag is stored as
+    // "add 0", so only one flag is needed. every value of T can be a tag,
+    // so the flag lives in set_ instead of padding the node
+    struct node_t {
+        T val;
+        T tag;
+    };
+
+    const T DEFAULT_;
+
+    // internal nodes [1, size_) live in node_ and leaves [size_, 2 * size_)
+    // in leaf_, which do not need a tag
+    std::vector<node_t> node_;
+    std::vector<bool>   set_; // if the tag of the node is a set
+    std::vector<T>      leaf_;
+    size_t              len_;
+    size_t              size_;
+    size_t              log_;
+
+    treeop_e type_;
+
+    inline T combine_ (const T &x, const T &y) const;
+
+    inline T &val_ (size_t pos);
+
+    inline void pushup_ (size_t pos);
+
+    inline void pushdown_ (size_t pos);
+
+    inline void apply_ (size_t pos, const T &val, bool set);
+
+public:
+    fused_tree (size_t len, T dft, const std::vector<T> &arr, treeop_e type);
+
+    /** Adds or sets a value to the range of elements [start, end]. */
+    void upd (size_t start, size_t end, T val, qtype_e qtype);
+
+    /** @return A query of the range [start, end]. */
+    T query (size_t start, size_t end);
+};
+
+/** A segment tree beats ("Ji driver" segment tree) supporting range chmin,
+ * range chmax and range add together with range sum, min and max queries in
+ * amortized O(log^2 n). */
+template <typename T> class beats_tree final
+{
+    // the largest and second largest distinct values and the number of times
+    // the largest occurs; likewise for the smallest values
+    struct node_t {
+        T      sum;
+        T      max1;
+        T      max2;
+        size_t maxc;
+        T      min1;
+        T      min2;
+        size_t minc;
+        T      add;
+    };
+
+    // 1-indexed recursive layout like tree: the children of node_[i] are
+    // node_[2i] and node_[2i + 1]
+    std::vector<node_t> node_;
+    size_t              len_;
+
+    inline void pushup_ (size_t pos);
+
+    inline void apply_add_ (size_t pos, size_t len, T val);
+
+    inline void apply_chmin_ (size_t pos, T val);
+
+    inline void apply_chmax_ (size_t pos, T val);
+
+    void pushdown_ (size_t pos, size_t lb, size_t mid, size_t rb);
+
+    void build_ (size_t pos, size_t lb, size_t rb, const std::vector<T> &arr);
+
+    void chmin_ (size_t start, size_t end, T val, size_t pos_, size_t lb_,
+                 size_t rb_);
+
+    void chmax_ (size_t start, size_t end, T val, size_t pos_, size_t lb_,
+                 size_t rb_);
+
+    void add_ (size_t start, size_t end, T val, size_t pos_, size_t lb_,
+               size_t rb_);
+
+    node_t query_ (size_t start, size_t end, size_t pos_, size_t lb_,
+                   size_t rb_);
+
+public:
+    beats_tree (const std::vector<T> &arr);
+
+    /** Sets every element a[i] in [start, end] to min (a[i], val). */
+    void chmin (size_t start, size_t end, T val);
+
+    /** Sets every element a[i] in [start, end] to max (a[i], val). */
+    void chmax (size_t start, size_t end, T val);
+
+    /** Adds val to every element in [start, end]. */
+    void add (size_t start, size_t end, T val);
+
+    /** @return The sum of the range [start, end]. */
+    T query_sum (size_t start, size_t end);
+
+    /** @return The minimum of the range [start, end]. */
+    T query_min (size_t start, size_t end);
+
+    /** @return The maximum of the range [start, end]. */
+    T query_max (size_t start, size_t end);
+};
+
+// ------ GENERIC LAZY ACTIONS ------ //
+
+// act_tree takes a monoid M and an action A on it as template parameters, so
+// every combine and apply is resolved at compile time.
+//
+// a monoid provides:
+//   using val_t = ...;
+//   static val_t id ();
+//   static val_t op (const val_t &x, const val_t &y);
+//
+// an action provides:
+//   using tag_t = ...;
+//   static tag_t id ();
+//   static tag_t compose (const tag_t &g, const tag_t &f); // g after f
+//   static M::val_t apply (const tag_t &f, const M::val_t &x, size_t len);
+//
+// where len is the number of elements that x aggregates.
+
+template <typename T> struct sum_op {
+    using val_t = T;
+
+    static T id () { return 0; }
+    static T op (const T &x, const T &y) { return x + y; }
+};
+
+template <typename T> struct min_op {
+    using val_t = T;
+
+    static T id () { return std::numeric_limits<T>::max (); }
+    static T op (const T &x, const T &y) { return x < y ? x : y; }
+};
+
+template <typename T> struct max_op {
+    using val_t = T;
+
+    static T id () { return std::numeric_limits<T>::lowest (); }
+    static T op (const T &x, const T &y) { return x < y ? y : x; }
+};
+
+/** Sums modulo MOD, which must be at most 2^63. */
+template <typename T, T MOD> struct mod_sum_op {
+    using val_t = T;
+
+    static T id () { return 0; }
+    static T
+    op (const T &x, const T &y)
+    {
+        T s = x + y;
+        return s >= MOD ? s - MOD : s;
+    }
+};
+
+/** x -> x + f on a sum. */
+template <typename T> struct add_sum_act {
+    using tag_t = T;
+
+    static T id () { return 0; }
+    static T compose (const T &g, const T &f) { return g + f; }
+    static T
+    apply (const T &f, const T &x, size_t len)
+    {
+        return x + f * (T)len;
+    }
+};
+
+/** x -> x + f on a min or max. */
+template <typename T> struct add_act {
+    using tag_t = T;
+
+    static T id () { return 0; }
+    static T compose (const T &g, const T &f) { return g + f; }
+    static T apply (const T &f, const T &x, size_t) { return x + f; }
+};
+
+/** x -> a * x + b on a sum, with the tag stored as { a, b }. */
+template <typename T> struct affine_act {
+    using tag_t = std::pair<T, T>;
+
+    static tag_t id () { return { 1, 0 }; }
+    static tag_t
+    compose (const tag_t &g, const tag_t &f)
+    {
+        return { g.first * f.first, g.first * f.second + g.second };
+    }
+    static T
+    apply (const tag_t &f, const T &x, size_t len)
+    {
+        return f.first * x + f.second * (T)len;
+    }
+};
+
+/** x -> a * x + b modulo MOD on a mod_sum_op, with the tag stored as
+ * { a, b }. Products are taken in 128 bits. */
+template <typename T, T MOD> struct affine_mod_act {
+    using tag_t = std::pair<T, T>;
+
+    __extension__ typedef unsigned __int128 wide_t;
+
+    static tag_t id () { return { 1, 0 }; }
+    static tag_t
+    compose (const tag_t &g, const tag_t &f)
+    {
+        return { (T)((wide_t)g.first * f.first % MOD),
+                 (T)(((wide_t)g.first * f.second + g.second) % MOD) };
+    }
+    static T
+    apply (const tag_t &f, const T &x, size_t len)
+    {
+        wide_t b = (wide_t)f.second * (len % MOD) % MOD;
+        return (T)(((wide_t)f.first * x + b) % MOD);
+    }
+};
+
+/** x -> min (x, f) on a min or max. */
+template <typename T> struct chmin_act {
+    using tag_t = T;
+
+    static T id () { return std::numeric_limits<T>::max (); }
+    static T compose (const T &g, const T &f) { return g < f ? g : f; }
+    static T apply (const T &f, const T &x, size_t) { return f < x ? f : x; }
+};
+
+/** x -> max (x, f) on a min or max. */
+template <typename T> struct chmax_act {
+    using tag_t = T;
+
+    static T id () { return std::numeric_limits<T>::lowest (); }
+    static T compose (const T &g, const T &f) { return g < f ? f : g; }
+    static T apply (const T &f, const T &x, size_t) { return f < x ? x : f; }
+};
+
+/** A lazy propagation segment tree over any monoid M and action A, using the
+ * non-recursive layout of iter_tree. */
+template <typename M, typename A> class act_tree final
+{
+    using val_t = typename M::val_t;
+    using tag_t = typename A::tag_t;
+
+    std::vector<val_t> tree_; // length of this is 2 * size_
+    std::vector<tag_t> lazy_; // tags of the internal nodes [1, size_)
+    size_t             len_;
+    size_t             size_;
+    size_t             log_;
+
+    void
+    pushup_ (size_t pos)
+    {
+        tree_[pos] = M::op (tree_[pos << 1], tree_[(pos << 1) + 1]);
+    }
+
+    void
+    apply_ (size_t pos, const tag_t &f)
+    {
+        size_t len = (size_t)1 << (log_ - (63 - __builtin_clzll (pos)));
+        tree_[pos] = A::apply (f, tree_[pos], len);
+
+        if (pos < size_)
+            lazy_[pos] = A::compose (f, lazy_[pos]);
+    }
+
+    void
+    pushdown_ (size_t pos)
+    {
+        apply_ (pos << 1, lazy_[pos]);
+        apply_ ((pos << 1) + 1, lazy_[pos]);
+        lazy_[pos] = A::id ();
+    }
+
+    /** Pushes the tags on the paths to the boundaries of [l, r). */
+    void
+    push_bounds_ (size_t l, size_t r)
+    {
+        for (size_t i = log_; i > 0; --i) {
+            if (((l >> i) << i) != l)
+                pushdown_ (l >> i);
+
+            if (((r >> i) << i) != r)
+                pushdown_ ((r - 1) >> i);
+        }
+    }
+
+public:
+    act_tree (const std::vector<val_t> &arr) : len_ (arr.size ())
+    {
+        log_  = len_ <= 1 ? 0 : 64 - __builtin_clzll (len_ - 1);
+        size_ = (size_t)1 << log_;
+
+        tree_.assign (size_ << 1, M::id ());
+        lazy_.assign (size_, A::id ());
+
+        for (size_t i = 0; i < len_; ++i)
+            tree_[size_ + i] = arr[i];
+
+        for (size_t i = size_ - 1; i > 0; --i)
+            pushup_ (i);
+    }
+
+    /** Sets the value at idx to val. */
+    void
+    set (size_t idx, const val_t &val)
+    {
+        idx += size_;
+        for (size_t i = log_; i > 0; --i)
+            pushdown_ (idx >> i);
+
+        tree_[idx] = val;
+
+        for (size_t i = 1; i <= log_; ++i)
+            pushup_ (idx >> i);
+    }
+
+    /** Applies f to every element in the range [start, end]. */
+    void
+    upd (size_t start, size_t end, const tag_t &f)
+    {
+        size_t l = start + size_;
+        size_t r = end + size_ + 1;
+
+        push_bounds_ (l, r);
+
+        for (size_t lo = l, hi = r; lo < hi; lo >>= 1, hi >>= 1) {
+            if (lo & 1)
+                apply_ (lo++, f);
+
+            if (hi & 1)
+                apply_ (--hi, f);
+        }
+
+        for (size_t i = 1; i <= log_; ++i) {
+            if (((l >> i) << i) != l)
+                pushup_ (l >> i);
+
+            if (((r >> i) << i) != r)
+                pushup_ ((r - 1) >> i);
+        }
+    }
+
+    /** @return A query of the range [start, end]. */
+    val_t
+    query (size_t start, size_t end)
+    {
+        size_t l = start + size_;
+        size_t r = end + size_ + 1;
+
+        push_bounds_ (l, r);
+
+        val_t lans = M::id ();
+        val_t rans = M::id ();
+        for (; l < r; l >>= 1, r >>= 1) {
+            if (l & 1)
+                lans = M::op (lans, tree_[l++]);
+
+            if (r & 1)
+                rans = M::op (tree_[--r], rans);
+        }
+
+        return M::op (lans, rans);
+    }
 };
 
 } // namespace lz_segtr
 
+namespace dyn_segtr
+{
+
+using lz_segtr::query_t;
+using lz_segtr::qtype_e;
+using lz_segtr::treeop_e;
+
+/** A lazy propagation segment tree over the coordinates [lb, rb] where nodes
+ * are only created once an update reaches them. Memory is O(q log U) for q
+ * updates over a universe of size U. Unreached positions hold the default
+ * value, so `dft` must be the identity of the tree operation. For MIN and
+ * MAX, positions that have never been set keep the identity when a range is
+ * added to. Sums wrap modulo 2^64 like unsigned arithmetic, so the sum over
+ * the whole 64 bit range is always a multiple of 2^64. */
+template <typename T> class tree final
+{
+    // node_[0] is a null sentinel: a child index of 0 means that the child
+    // has not been created yet and its whole range still holds DEFAULT_.
+    // node_[1] is the root covering [lb_, rb_].
+    struct node_t {
+        T          val;
+        query_t<T> lazy;
+        uint32_t   lc;
+        uint32_t   rc;
+    };
+
+    const T DEFAULT_;
+
+    std::vector<node_t> node_; // pool of nodes, grows on demand
+    std::vector<bool>   used_; // if a position under the node has been set
+    uint64_t            lb_;
+    uint64_t            rb_;
+    treeop_e            type_;
+
+    std::function<T (const T &, const T &)> combine_;
+    std::function<T (const T &, uint64_t)>  upd_upstream_;
+
+    /** @return The index of a new node in the pool. */
+    inline uint32_t alloc_ ();
+
+    inline void pushup_ (uint32_t pos);
+
+    void pushdown_ (uint32_t pos, uint64_t lb, uint64_t mid, uint64_t rb);
+
+    void apply_ (uint32_t pos, uint64_t len, const query_t<T> &q);
+
+    void upd_ (uint64_t start, uint64_t end, const query_t<T> &q,
+               uint32_t pos_, uint64_t lb_, uint64_t rb_);
+
+    T query_ (uint64_t start, uint64_t end, uint32_t pos_, uint64_t lb_,
+              uint64_t rb_);
+
+public:
+    /** @param `cap`: the number of nodes to reserve in the pool up front. */
+    tree (uint64_t lb, uint64_t rb, T dft, treeop_e type, size_t cap = 0);
+
+    /** Sets the value at idx to val. */
+    void set (uint64_t idx, T val);
+
+    /** Adds or sets a value to the range of elements [start, end]. */
+    void upd (uint64_t start, uint64_t end, T val, qtype_e qtype);
+
+    /** @return A query of the range [start, end]. */
+    T query (uint64_t start, uint64_t end);
+
+    /** @return The number of nodes that have been allocated. */
+    size_t size () const;
+};
+
+} // namespace dyn_segtr
+
 } // namespace ext
 
 #endif
@@ -2,8 +2,11 @@
 #ifndef UTIL_HH
 #define UTIL_HH
 
+#include <cstddef>
 #include <cstdint>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace ext
 {
@@ -11,7 +14,16 @@ namespace ext
 namespace utl
 {
 
-template <typename T> T next_p2 (T x);
+/** @return The smallest power of two that is at least x. */
+template <typename T>
+constexpr T
+next_p2 (T x)
+{
+    if (x <= 1)
+        return 1;
+
+    return (T)1 << (64 - __builtin_clzll ((uint64_t)x - 1));
+}
 
 class rational_number
 {
@@ -30,6 +42,189 @@ public:
     long double value () const;
 };
 
+/** A rational number for long chains of arithmetic. Products are taken in
+ * 128 bits and the fraction is only reduced, with a binary gcd, once its
+ * numerator or denominator no longer fits in 64 bits, or when it is read.
+ * The result of every operation must fit in 64 bits once reduced. */
+class lazy_rational
+{
+    __extension__ typedef __int128 wide_t;
+
+    // d_ is positive, and both are below LIMIT_ in magnitude between
+    // operations
+    wide_t n_;
+    wide_t d_;
+
+    static constexpr wide_t LIMIT_ = (wide_t)1 << 63;
+
+    /** @return n / d, with d moved to the positive side. */
+    static lazy_rational make_ (wide_t n, wide_t d);
+
+    /** Reduces the fraction if it has grown past LIMIT_. */
+    void fit_ ();
+
+    /** Divides both parts by their gcd. */
+    void reduce_ ();
+
+public:
+    lazy_rational (int64_t n = 0, int64_t d = 1);
+    lazy_rational (const rational_number &r);
+
+    lazy_rational operator+ (const lazy_rational &other) const;
+    lazy_rational operator- (const lazy_rational &other) const;
+    lazy_rational operator* (const lazy_rational &other) const;
+    lazy_rational operator/ (const lazy_rational &other) const;
+
+    lazy_rational &operator+= (const lazy_rational &other);
+    lazy_rational &operator-= (const lazy_rational &other);
+    lazy_rational &operator*= (const lazy_rational &other);
+    lazy_rational &operator/= (const lazy_rational &other);
+
+    bool operator< (const lazy_rational &other) const;
+    bool operator> (const lazy_rational &other) const;
+    bool operator== (const lazy_rational &other) const;
+
+    /** @return The fraction in lowest terms. */
+    rational_number reduced () const;
+
+    long double value () const;
+};
+
+/** Rational numbers stored as an array of numerators and one of
+ * denominators, with kernels that run over the whole array at once. Unlike
+ * rational_number's, results stay unreduced until reduce is called, so
+ * their numerators and denominators must fit in 64 bits until then. */
+class rational_array
+{
+    std::vector<int64_t> n_;
+    std::vector<int64_t> d_;
+
+public:
+    rational_array (size_t len = 0);
+    rational_array (const std::vector<rational_number> &vals);
+
+    void push_back (const rational_number &val);
+
+    rational_number get (size_t idx) const;
+    void            set (size_t idx, const rational_number &val);
+
+    /** Applies the operation to each element and the element of other at
+     * the same index, which must have the same length. */
+    void add (const rational_array &other);
+    void sub (const rational_array &other);
+    void mul (const rational_array &other);
+    void div (const rational_array &other);
+
+    /** Multiplies every element by factor. */
+    void scale (const rational_number &factor);
+
+    /** @return Whether each element is less than the element of other at the
+     * same index. */
+    std::vector<uint8_t> less (const rational_array &other) const;
+
+    /** Puts every element in lowest terms with a positive denominator. An
+     * element that reduces to INT64_MIN over a negative denominator has no
+     * such form in 64 bits and overflows. */
+    void reduce ();
+
+    /** Sorts the elements by their exact value. Elements with a zero
+     * denominator are put last, in their original order.
+     * @return The index each element had before. */
+    std::vector<size_t> sort ();
+
+    size_t size () const;
+};
+
+/** An arbitrary precision integer, stored as a sign and the 64-bit limbs
+ * of its magnitude from the least significant up. Products switch from
+ * schoolbook to Karatsuba to Toom-3 as the operands grow, and division is
+ * Knuth's algorithm D. / and % truncate towards zero, like they do on
+ * built-in integers, and dividing by zero is undefined. */
+class big_int
+{
+    std::vector<uint64_t> mag_; // no leading zero limbs, empty for zero
+    bool                  neg_; // never set for zero
+
+    big_int (std::vector<uint64_t> mag, bool neg);
+
+public:
+    big_int (int64_t val = 0);
+
+    /** Parses an optionally signed decimal number. */
+    explicit big_int (const std::string &str);
+
+    big_int operator+ (const big_int &other) const;
+    big_int operator- (const big_int &other) const;
+    big_int operator* (const big_int &other) const;
+    big_int operator/ (const big_int &other) const;
+    big_int operator% (const big_int &other) const;
+    big_int operator- () const;
+
+    big_int &operator+= (const big_int &other);
+    big_int &operator-= (const big_int &other);
+    big_int &operator*= (const big_int &other);
+    big_int &operator/= (const big_int &other);
+    big_int &operator%= (const big_int &other);
+
+    bool operator< (const big_int &other) const;
+    bool operator> (const big_int &other) const;
+    bool operator== (const big_int &other) const;
+    bool operator!= (const big_int &other) const;
+
+    /** Sets quot and rem to this / other and this % other at once. */
+    void divmod (const big_int &other, big_int &quot, big_int &rem) const;
+
+    /** @return This to the power of exp modulo mod, in [0, mod), for a
+     * non-negative exp and a positive mod. */
+    big_int pow_mod (const big_int &exp, const big_int &mod) const;
+
+    /** @return The non-negative gcd of a and b. */
+    static big_int gcd (big_int a, big_int b);
+
+    bool is_zero () const;
+    bool is_neg () const;
+
+    /** @return The number of bits of the magnitude. */
+    size_t bits () const;
+
+    /** @return The decimal representation. */
+    std::string str () const;
+
+    long double value () const;
+};
+
+/** A rational number over big_int, kept in lowest terms with a positive
+ * denominator. */
+class big_rational
+{
+    big_int n_;
+    big_int d_;
+
+    /** Divides both parts by their gcd and moves the sign up. */
+    void reduce_ ();
+
+public:
+    big_rational (const big_int &n = 0, const big_int &d = 1);
+    big_rational (const rational_number &r);
+
+    big_rational operator+ (const big_rational &other) const;
+    big_rational operator- (const big_rational &other) const;
+    big_rational operator* (const big_rational &other) const;
+    big_rational operator/ (const big_rational &other) const;
+
+    bool operator< (const big_rational &other) const;
+    bool operator> (const big_rational &other) const;
+    bool operator== (const big_rational &other) const;
+
+    const big_int &num () const;
+    const big_int &den () const;
+
+    /** @return The fraction as n/d, or just n if d is 1. */
+    std::string str () const;
+
+    long double value () const;
+};
+
 template <typename T1, typename T2, typename T3> class tup
 {
     std::pair<T1, std::pair<T2, T3> > c_;